@@ -22,13 +22,40 @@ struct Transform
 	vf2d position{ 0.0f, 0.0f };
 };
 
-struct Name
+// Offset from the parent's Transform, for entities attached through ecs::hierarchy
+struct Attachment
 {
 	using storage_type = ecs::default_storage_t;
 
-	Name(std::string name)
-		:value(std::move(name)) {}
-	std::string value;
+	Attachment(vf2d offset) :
+		offset(offset) {}
+
+	vf2d offset{ 0.0f, 0.0f };
+};
+
+struct Name
+{
+	using storage_type = ecs::virtual_storage_t;
+
+	Name(std::string_view name)
+		:value(name) {}
+	ecs::interned_string value;
+};
+
+template<>
+struct ecs::serializer<Name>
+{
+	using encoded_type = uint32_t;
+
+	static encoded_type encode(const Name& name, ecs::string_table& strings)
+	{
+		return strings.add(name.value.view());
+	}
+
+	static Name decode(encoded_type value, const ecs::string_table_view& strings)
+	{
+		return Name(strings.get(value));
+	}
 };
 
 struct Graphic
@@ -1,12 +1,55 @@
 #pragma once
 #include "ecs.h"
+#include "memory.h"
+#include <algorithm>
 #include <memory>
 #include <cassert>
+#include <memory_resource>
+#include <type_traits>
 #include <vector>
 
 namespace ecs::detail {
 
-	
+	using relocate_fn = void(*)(void* destination, void* source);
+
+	// Move constructs the component into destination and destroys the source.
+	template<typename T>
+	void relocate_component(void* destination, void* source)
+	{
+		T* component = static_cast<T*>(source);
+		::new(destination) T(std::move(*component));
+		component->~T();
+	}
+
+	template<typename T, typename = void>
+	struct alignment_override
+	{
+		constexpr static size_t value = 0;
+	};
+
+	template<typename T>
+	struct alignment_override<T, std::void_t<decltype(T::alignment)>>
+	{
+		constexpr static size_t value = T::alignment;
+	};
+
+	// Components may raise their alignment with a static alignment member, for
+	// example 32 or 64 to get aligned SIMD loads or one component per cache line.
+	template<typename T>
+	constexpr size_t component_alignment()
+	{
+		constexpr auto alignment = std::max(alignof(T), alignment_override<T>::value);
+		static_assert((alignment & (alignment - 1)) == 0, "Component alignment must be a power of two");
+		return alignment;
+	}
+
+	// Distance between consecutive components in a pool, keeps every element aligned.
+	template<typename T>
+	constexpr size_t component_stride()
+	{
+		constexpr auto alignment = component_alignment<T>();
+		return (sizeof(T) + alignment - 1) & ~(alignment - 1);
+	}
 
 	template<typename tag_t>
 	struct component_pool
@@ -18,10 +61,11 @@ namespace ecs::detail {
 	struct component_pool<default_storage_t>
 	{
 		component_pool() = default;
-		component_pool(size_t elementsize)
-			:elementSize(elementsize)
+		component_pool(size_t elementsize, size_t alignment, relocate_fn relocate, std::pmr::memory_resource* resource)
+			:elementSize(elementsize), relocate(relocate)
 		{
-			storage = std::make_unique<uint8_t[]>(elementSize * default_storage_t::size);
+			// One extra element is scratch space for swap
+			storage = allocate_buffer(resource, elementSize * (default_storage_t::size + 1), std::max(alignment, alignof(std::max_align_t)));
 		}
 
 		inline void* get(size_t index)
@@ -29,19 +73,33 @@ namespace ecs::detail {
 			return &storage[index * elementSize];
 		}
 
-		std::unique_ptr<uint8_t[]> storage{ nullptr };
+		void move(size_t from, size_t to)
+		{
+			relocate(get(to), get(from));
+		}
+
+		void swap(size_t a, size_t b)
+		{
+			const auto scratch = get(default_storage_t::size);
+			relocate(scratch, get(a));
+			relocate(get(a), get(b));
+			relocate(get(b), scratch);
+		}
+
+		buffer_ptr storage{ nullptr };
 		const size_t elementSize{ 0 };
+		const relocate_fn relocate{ nullptr };
 	};
 
 	template<>
 	struct component_pool<small_storage_t>
 	{
 		component_pool() = default;
-		component_pool(size_t elementsize)
-			:elementSize(elementsize)
+		component_pool(size_t elementsize, size_t alignment, relocate_fn relocate, std::pmr::memory_resource* resource)
+			:index_mapping(resource), elementSize(elementsize), relocate(relocate)
 		{
 			index_mapping.reserve(small_storage_t::size);
-			storage = std::make_unique<uint8_t[]>(elementSize * small_storage_t::size);
+			storage = allocate_buffer(resource, elementSize * small_storage_t::size, std::max(alignment, alignof(std::max_align_t)));
 		}
 
 		inline void* get(size_t index)
@@ -50,7 +108,7 @@ namespace ecs::detail {
 			auto mapped_index = std::find(index_mapping.begin(), index_mapping.end(), index);
 			if (mapped_index != index_mapping.end())
 			{
-				return storage.get() + *mapped_index * elementSize;
+				return storage.get() + std::distance(index_mapping.begin(), mapped_index) * elementSize;
 			}
 			else
 			{
@@ -61,13 +119,103 @@ namespace ecs::detail {
 			}
 		}
 
+		// Components stay where they are, only the owning indices are swapped.
+		void move(size_t from, size_t to)
+		{
+			for (auto& mapped_index : index_mapping)
+			{
+				if (mapped_index == from)
+				{
+					mapped_index = to;
+				}
+				else if (mapped_index == to)
+				{
+					mapped_index = from;
+				}
+			}
+		}
+
+		void swap(size_t a, size_t b)
+		{
+			move(a, b);
+		}
+
 		const auto& active_entities()
 		{
 			return index_mapping;
 		}
 
-		std::vector<size_t> index_mapping;
-		std::unique_ptr<uint8_t[]> storage{ nullptr };
+		std::pmr::vector<size_t> index_mapping;
+		buffer_ptr storage{ nullptr };
+		const size_t elementSize{ 0 };
+		const relocate_fn relocate{ nullptr };
+	};
+
+	// Bypasses the memory resource, the pool reserves its own address space and
+	// commits it in chunks as components are added.
+	template<>
+	struct component_pool<virtual_storage_t>
+	{
+		constexpr static size_t chunk_size = 64 * 1024;
+
+		component_pool() = default;
+		component_pool(size_t elementsize, size_t alignment, relocate_fn relocate, std::pmr::memory_resource* resource)
+			:elementSize(elementsize), relocate(relocate), committed_chunks(resource)
+		{
+			// Reserved memory starts on a page boundary
+			assert(alignment <= chunk_size && "Component alignment larger than a chunk");
+
+			// One extra element is scratch space for swap
+			const auto reserved = (elementSize * (virtual_storage_t::size + 1) + chunk_size - 1) & ~(chunk_size - 1);
+			storage = virtual_ptr(reserve_virtual(reserved), virtual_deleter{ reserved });
+			committed_chunks.resize(reserved / chunk_size);
+			commit(virtual_storage_t::size);
+		}
+
+		inline void* get(size_t index)
+		{
+			return &storage[index * elementSize];
+		}
+
+		// Must be called before the first write to index.
+		void commit(size_t index)
+		{
+			const auto first_chunk = index * elementSize / chunk_size;
+			const auto last_chunk = ((index + 1) * elementSize - 1) / chunk_size;
+			for (auto chunk = first_chunk; chunk <= last_chunk; ++chunk)
+			{
+				if (!committed_chunks[chunk]) [[unlikely]]
+				{
+					commit_virtual(&storage[chunk * chunk_size], chunk_size);
+					committed_chunks[chunk] = true;
+					committed += chunk_size;
+				}
+			}
+		}
+
+		void move(size_t from, size_t to)
+		{
+			commit(to);
+			relocate(get(to), get(from));
+		}
+
+		void swap(size_t a, size_t b)
+		{
+			const auto scratch = get(virtual_storage_t::size);
+			relocate(scratch, get(a));
+			relocate(get(a), get(b));
+			relocate(get(b), scratch);
+		}
+
+		size_t committed_bytes() const
+		{
+			return committed;
+		}
+
+		virtual_ptr storage{ nullptr };
 		const size_t elementSize{ 0 };
+		const relocate_fn relocate{ nullptr };
+		std::pmr::vector<bool> committed_chunks;
+		size_t committed{ 0 };
 	};
 }
\ No newline at end of file
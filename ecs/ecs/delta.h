@@ -0,0 +1,284 @@
+#pragma once
+
+#include "ecs.h"
+#include "snapshot.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ecs {
+
+	// Difference between two snapshots, for rollback and replication.
+	struct delta
+	{
+		std::vector<uint8_t> bytes;
+	};
+
+	namespace detail {
+		constexpr uint32_t delta_magic = 0x44534345; // "ECSD"
+
+		// Followed by the target's pool directory and then one run list for the entity
+		// table, the handle table and each pool, in directory order.
+		struct delta_header
+		{
+			uint32_t magic{ delta_magic };
+			uint32_t padding{ 0 };
+			snapshot_header target;
+		};
+
+		// A run list is a uint32_t run count followed by the runs, each a delta_run
+		// and then count * stride bytes of new data.
+		struct delta_run
+		{
+			uint32_t first{ 0 };
+			uint32_t count{ 0 };
+		};
+
+		// Blocks this large are compared with a single memcmp before looking at elements.
+		constexpr size_t delta_block_size = 4096;
+
+		inline void append(std::vector<uint8_t>& out, const void* data, size_t size)
+		{
+			const auto bytes = static_cast<const uint8_t*>(data);
+			out.insert(out.end(), bytes, bytes + size);
+		}
+
+		inline bool is_zero(const uint8_t* data, size_t size)
+		{
+			static const uint8_t zeros[delta_block_size]{};
+			for (size_t offset = 0; offset < size; offset += delta_block_size)
+			{
+				if (std::memcmp(data + offset, zeros, std::min(delta_block_size, size - offset)) != 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Records the elements of to that differ from from. Elements past the end of
+		// from are compared against zeros, which is what snapshots store for slots whose
+		// entity lacks the component.
+		inline void encode_runs(const uint8_t* from, size_t from_count, const uint8_t* to, size_t to_count, size_t stride, std::vector<uint8_t>& out)
+		{
+			const auto run_count_offset = out.size();
+			uint32_t run_count = 0;
+			append(out, &run_count, sizeof(run_count));
+
+			delta_run run;
+			const auto close_run = [&]()
+			{
+				if (run.count > 0)
+				{
+					append(out, &run, sizeof(run));
+					append(out, to + size_t(run.first) * stride, size_t(run.count) * stride);
+					run_count++;
+					run.count = 0;
+				}
+			};
+			const auto mark_changed = [&](size_t index)
+			{
+				if (run.count > 0 && run.first + run.count == index)
+				{
+					run.count++;
+					return;
+				}
+				close_run();
+				run.first = static_cast<uint32_t>(index);
+				run.count = 1;
+			};
+
+			const auto common = std::min(from_count, to_count);
+			const auto block_elements = std::max<size_t>(1, delta_block_size / stride);
+			for (size_t block = 0; block < common; block += block_elements)
+			{
+				const auto block_end = std::min(common, block + block_elements);
+				if (std::memcmp(from + block * stride, to + block * stride, (block_end - block) * stride) == 0)
+				{
+					continue;
+				}
+
+				for (auto index = block; index < block_end; ++index)
+				{
+					if (std::memcmp(from + index * stride, to + index * stride, stride) != 0)
+					{
+						mark_changed(index);
+					}
+				}
+			}
+
+			for (auto block = common; block < to_count; block += block_elements)
+			{
+				const auto block_end = std::min(to_count, block + block_elements);
+				if (is_zero(to + block * stride, (block_end - block) * stride))
+				{
+					continue;
+				}
+
+				for (auto index = block; index < block_end; ++index)
+				{
+					if (!is_zero(to + index * stride, stride))
+					{
+						mark_changed(index);
+					}
+				}
+			}
+			close_run();
+
+			std::memcpy(out.data() + run_count_offset, &run_count, sizeof(run_count));
+		}
+
+		// Copies the common prefix of from and zeros the rest, matching encode_runs, then
+		// applies the run list read at cursor.
+		inline bool apply_runs(const uint8_t* from, size_t from_count, uint8_t* to, size_t to_count, size_t stride, const uint8_t*& cursor, const uint8_t* end)
+		{
+			const auto common = std::min(from_count, to_count);
+			if (common > 0)
+			{
+				std::memcpy(to, from, common * stride);
+			}
+			if (to_count > common)
+			{
+				std::memset(to + common * stride, 0, (to_count - common) * stride);
+			}
+
+			uint32_t run_count = 0;
+			if (cursor + sizeof(run_count) > end)
+			{
+				return false;
+			}
+			std::memcpy(&run_count, cursor, sizeof(run_count));
+			cursor += sizeof(run_count);
+
+			for (uint32_t i = 0; i < run_count; ++i)
+			{
+				delta_run run;
+				if (cursor + sizeof(run) > end)
+				{
+					return false;
+				}
+				std::memcpy(&run, cursor, sizeof(run));
+				cursor += sizeof(run);
+
+				const auto bytes = size_t(run.count) * stride;
+				if (size_t(run.first) + run.count > to_count || cursor + bytes > end)
+				{
+					return false;
+				}
+				std::memcpy(to + size_t(run.first) * stride, cursor, bytes);
+				cursor += bytes;
+			}
+			return true;
+		}
+
+		// Pools are diffed element by element. Records whose size isn't a multiple of the
+		// stride, which some small pools produce, are diffed as a single block.
+		inline size_t delta_stride(const snapshot_pool& record)
+		{
+			return (record.stride > 0 && record.size % record.stride == 0) ? record.stride : size_t(record.size);
+		}
+
+		inline size_t delta_count(const snapshot_pool* record, size_t stride)
+		{
+			return (record && stride > 0) ? size_t(record->size / stride) : 0;
+		}
+	}
+
+	// Encodes what changed between two snapshots of the same world: created and destroyed
+	// entities and mask changes through the entity table, versions through the handle
+	// table, and changed components per pool. Equal regions are skipped a block at a time.
+	inline bool encode_delta(const ecs::snapshot& from, const ecs::snapshot& to, ecs::delta& out)
+	{
+		detail::snapshot_view source;
+		detail::snapshot_view target;
+		if (!source.parse(from.bytes.data(), from.bytes.size()) || !target.parse(to.bytes.data(), to.bytes.size()))
+		{
+			return false;
+		}
+
+		out.bytes.clear();
+		detail::delta_header header;
+		header.target = target.header;
+		detail::append(out.bytes, &header, sizeof(header));
+		detail::append(out.bytes, target.pools.data(), target.pools.size() * sizeof(detail::snapshot_pool));
+
+		detail::encode_runs(source.entities, source.header.entity_count, target.entities, target.header.entity_count,
+			sizeof(detail::snapshot_entity), out.bytes);
+		detail::encode_runs(source.handles, source.header.handle_count, target.handles, target.header.handle_count,
+			sizeof(ecs::world::entity_handle), out.bytes);
+
+		for (const auto& record : target.pools)
+		{
+			const auto stride = detail::delta_stride(record);
+			const auto previous = source.find_pool(record.schema);
+			const auto previous_data = previous ? source.data + previous->offset : nullptr;
+			detail::encode_runs(previous_data, detail::delta_count(previous, stride), target.data + record.offset,
+				detail::delta_count(&record, stride), stride, out.bytes);
+		}
+		return true;
+	}
+
+	// Rebuilds the target snapshot of delta from the snapshot it was encoded against.
+	// Reuses the capacity of to.
+	inline bool apply_delta(const ecs::snapshot& from, const ecs::delta& delta, ecs::snapshot& to)
+	{
+		detail::snapshot_view source;
+		if (!source.parse(from.bytes.data(), from.bytes.size()) || delta.bytes.size() < sizeof(detail::delta_header))
+		{
+			return false;
+		}
+
+		detail::delta_header header;
+		std::memcpy(&header, delta.bytes.data(), sizeof(header));
+		if (header.magic != detail::delta_magic || header.target.pool_count > MAX_COMPONENTS)
+		{
+			return false;
+		}
+
+		auto cursor = delta.bytes.data() + sizeof(header);
+		const auto end = delta.bytes.data() + delta.bytes.size();
+		std::vector<detail::snapshot_pool> records(header.target.pool_count);
+		if (cursor + records.size() * sizeof(detail::snapshot_pool) > end)
+		{
+			return false;
+		}
+		std::memcpy(records.data(), cursor, records.size() * sizeof(detail::snapshot_pool));
+		cursor += records.size() * sizeof(detail::snapshot_pool);
+
+		const auto& target = header.target;
+		to.bytes.resize(detail::layout_snapshot(target, records));
+
+		auto output = to.bytes.data();
+		std::memcpy(output, &target, sizeof(target));
+		output += sizeof(target);
+
+		if (!detail::apply_runs(source.entities, source.header.entity_count, output, target.entity_count,
+			sizeof(detail::snapshot_entity), cursor, end))
+		{
+			return false;
+		}
+		output += size_t(target.entity_count) * sizeof(detail::snapshot_entity);
+
+		if (!detail::apply_runs(source.handles, source.header.handle_count, output, target.handle_count,
+			sizeof(ecs::world::entity_handle), cursor, end))
+		{
+			return false;
+		}
+		output += size_t(target.handle_count) * sizeof(ecs::world::entity_handle);
+
+		std::memcpy(output, records.data(), records.size() * sizeof(detail::snapshot_pool));
+
+		for (const auto& record : records)
+		{
+			const auto stride = detail::delta_stride(record);
+			const auto previous = source.find_pool(record.schema);
+			const auto previous_data = previous ? source.data + previous->offset : nullptr;
+			if (!detail::apply_runs(previous_data, detail::delta_count(previous, stride), to.bytes.data() + record.offset,
+				detail::delta_count(&record, stride), stride, cursor, end))
+			{
+				return false;
+			}
+		}
+		return cursor == end;
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <bitset>
+#include <limits>
 
 
 namespace ecs {
@@ -29,6 +30,11 @@ namespace ecs {
 	struct small_storage_t {
 		constexpr static size_t size = 8;
 	};
+	// Address space for every entity is reserved up front, but pages are only
+	// committed once an entity at that index gets the component.
+	struct virtual_storage_t {
+		constexpr static size_t size = MAX_ENTITIES;
+	};
 
 
 	constexpr entity_id create_entity_id(entity_index index, entity_version version)
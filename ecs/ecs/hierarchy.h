@@ -0,0 +1,297 @@
+#pragma once
+
+#include "ecs.h"
+#include "world.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+
+namespace ecs {
+
+	// Links an entity into a hierarchy, children of a parent form a doubly linked list.
+	// Managed by ecs::hierarchy, don't change the links directly.
+	struct hierarchy_node
+	{
+		using storage_type = default_storage_t;
+
+		entity_id parent{ INVALID_ENTITY };
+		entity_id first_child{ INVALID_ENTITY };
+		entity_id next_sibling{ INVALID_ENTITY };
+		entity_id previous_sibling{ INVALID_ENTITY };
+	};
+
+	// Parent child relationships between entities of a world. Keeps every node in a
+	// flat breadth first order where each parent comes before its children. Rebuilding
+	// that order after a structural change also packs the nodes into the world's table
+	// in the same order, so propagate walks the component pools front to back.
+	// Nodes in the world's group keep their slots. Entities moved later, by compaction
+	// or group changes, are still found, only less cheaply until the next rebuild.
+	// Rebuilding moves entities, so don't propagate while iterating a view.
+	// Destroying an entity detaches it and turns its children into roots.
+	struct hierarchy
+	{
+		explicit hierarchy(ecs::world& world)
+			:world(&world), order(world.resource), parent_positions(world.resource),
+			slots(world.resource), dirty(world.resource), positions(world.resource)
+		{
+			world.observe({ detail::type_id<hierarchy_node>(), this,
+				[](void* context, ecs::world&, entity_id)
+				{
+					static_cast<hierarchy*>(context)->structure_changed = true;
+				},
+				[](void* context, ecs::world&, entity_id entity)
+				{
+					static_cast<hierarchy*>(context)->unlink(entity);
+				},
+				[](void* context)
+				{
+					static_cast<hierarchy*>(context)->structure_changed = true;
+				} });
+		}
+
+		~hierarchy()
+		{
+			world->unobserve(this);
+		}
+
+		hierarchy(const hierarchy&) = delete;
+		hierarchy& operator=(const hierarchy&) = delete;
+
+		// Makes child the first child of parent, detaching it from its old parent.
+		void attach(entity_id child, entity_id parent)
+		{
+			for (auto ancestor = parent; ancestor != INVALID_ENTITY; ancestor = parent_of(ancestor))
+			{
+				if (ancestor == child) [[unlikely]]
+				{
+					std::cerr << "Attach would create a cycle!\n";
+					return;
+				}
+			}
+
+			ensure_node(child);
+			ensure_node(parent);
+			detach(child);
+			auto& child_node = world->get_component<hierarchy_node>(child);
+			auto& parent_node = world->get_component<hierarchy_node>(parent);
+
+			child_node.parent = parent;
+			child_node.next_sibling = parent_node.first_child;
+			if (parent_node.first_child != INVALID_ENTITY)
+			{
+				world->get_component<hierarchy_node>(parent_node.first_child).previous_sibling = child;
+			}
+			parent_node.first_child = child;
+			structure_changed = true;
+		}
+
+		void detach(entity_id child)
+		{
+			auto links = world->try_get_component<hierarchy_node>(child);
+			if (!links || links->parent == INVALID_ENTITY)
+			{
+				return;
+			}
+
+			if (links->previous_sibling != INVALID_ENTITY)
+			{
+				world->get_component<hierarchy_node>(links->previous_sibling).next_sibling = links->next_sibling;
+			}
+			else
+			{
+				world->get_component<hierarchy_node>(links->parent).first_child = links->next_sibling;
+			}
+
+			if (links->next_sibling != INVALID_ENTITY)
+			{
+				world->get_component<hierarchy_node>(links->next_sibling).previous_sibling = links->previous_sibling;
+			}
+
+			links->parent = INVALID_ENTITY;
+			links->next_sibling = INVALID_ENTITY;
+			links->previous_sibling = INVALID_ENTITY;
+			structure_changed = true;
+		}
+
+		entity_id parent_of(entity_id entity)
+		{
+			const auto links = world->try_get_component<hierarchy_node>(entity);
+			return links ? links->parent : INVALID_ENTITY;
+		}
+
+		template<typename Func>
+		void for_each_child(entity_id parent, Func&& func)
+		{
+			const auto links = world->try_get_component<hierarchy_node>(parent);
+			for (auto child = links ? links->first_child : INVALID_ENTITY; child != INVALID_ENTITY;)
+			{
+				const auto next = world->get_component<hierarchy_node>(child).next_sibling;
+				func(child);
+				child = next;
+			}
+		}
+
+		// Flags entity and its subtree for the next propagate. Attached entities are
+		// recomputed from their parent, so change Local on those and Global on roots.
+		void mark_dirty(entity_id entity)
+		{
+			if (structure_changed)
+			{
+				return;
+			}
+
+			const auto handle = get_entity_index(entity);
+			if (handle < positions.size() && positions[handle] != INVALID_ENTITY_INDEX)
+			{
+				dirty[positions[handle]] = 1;
+			}
+		}
+
+		// Calls func(parent_global, child_local, child_global) for every child in a dirty
+		// subtree that has Local and Global and whose parent has Global. Subtrees nobody
+		// marked dirty are skipped, after a structural change everything is updated.
+		template<ECS_COMPONENT Global, ECS_COMPONENT Local, typename Func>
+		void propagate(Func&& func)
+		{
+			if (structure_changed)
+			{
+				rebuild_order();
+			}
+
+			for (size_t position = 0; position < order.size(); ++position)
+			{
+				const auto parent_position = parent_positions[position];
+				if (parent_position == INVALID_ENTITY_INDEX)
+				{
+					continue;
+				}
+
+				// Parents come first, so their flag is final by now.
+				dirty[position] |= dirty[parent_position];
+				if (!dirty[position])
+				{
+					continue;
+				}
+
+				const auto slot = slot_of(position);
+				const auto parent_global = world->try_get_component_at<Global>(slot_of(parent_position));
+				const auto local = world->try_get_component_at<Local>(slot);
+				const auto global = world->try_get_component_at<Global>(slot);
+				if (parent_global && local && global)
+				{
+					func(*parent_global, *local, *global);
+				}
+			}
+			std::fill(dirty.begin(), dirty.end(), uint8_t{ 0 });
+		}
+
+		// Every node in breadth first order, roots first.
+		const std::pmr::vector<entity_id>& nodes()
+		{
+			if (structure_changed)
+			{
+				rebuild_order();
+			}
+			return order;
+		}
+
+	private:
+		void ensure_node(entity_id entity)
+		{
+			if (!world->try_get_component<hierarchy_node>(entity))
+			{
+				world->add_component<hierarchy_node>(entity);
+			}
+		}
+
+		// Runs before entity loses its node, its children become roots.
+		void unlink(entity_id entity)
+		{
+			detach(entity);
+
+			auto& links = world->get_component<hierarchy_node>(entity);
+			for (auto child = links.first_child; child != INVALID_ENTITY;)
+			{
+				auto& child_node = world->get_component<hierarchy_node>(child);
+				const auto next = child_node.next_sibling;
+				child_node.parent = INVALID_ENTITY;
+				child_node.next_sibling = INVALID_ENTITY;
+				child_node.previous_sibling = INVALID_ENTITY;
+				child = next;
+			}
+			links.first_child = INVALID_ENTITY;
+			structure_changed = true;
+		}
+
+		void rebuild_order()
+		{
+			order.clear();
+			parent_positions.clear();
+			std::fill(positions.begin(), positions.end(), INVALID_ENTITY_INDEX);
+
+			const auto push = [&](entity_id entity, entity_index parent_position)
+			{
+				const auto handle = get_entity_index(entity);
+				if (positions.size() <= handle)
+				{
+					positions.resize(handle + 1, INVALID_ENTITY_INDEX);
+				}
+				positions[handle] = static_cast<entity_index>(order.size());
+				order.push_back(entity);
+				parent_positions.push_back(parent_position);
+			};
+
+			ecs::view<hierarchy_node>(*world).for_each_entity([&](entity_id entity, const hierarchy_node& links)
+				{
+					if (links.parent == INVALID_ENTITY)
+					{
+						push(entity, INVALID_ENTITY_INDEX);
+					}
+				});
+
+			// order doubles as the breadth first queue.
+			for (size_t position = 0; position < order.size(); ++position)
+			{
+				const auto& links = world->get_component<hierarchy_node>(order[position]);
+				for (auto child = links.first_child; child != INVALID_ENTITY;)
+				{
+					push(child, static_cast<entity_index>(position));
+					child = world->get_component<hierarchy_node>(child).next_sibling;
+				}
+			}
+
+			world->pack(order);
+			slots.resize(order.size());
+			for (size_t position = 0; position < order.size(); ++position)
+			{
+				slots[position] = world->get_entity_slot(order[position]);
+			}
+
+			dirty.assign(order.size(), 1);
+			structure_changed = false;
+		}
+
+		entity_index slot_of(size_t position)
+		{
+			auto& slot = slots[position];
+			if (slot >= world->scan_end || world->entities[slot].id != order[position]) [[unlikely]]
+			{
+				slot = world->get_entity_slot(order[position]);
+			}
+			return slot;
+		}
+
+		ecs::world* world{ nullptr };
+		std::pmr::vector<entity_id> order;
+		// Position of each node's parent in order, INVALID_ENTITY_INDEX for roots.
+		std::pmr::vector<entity_index> parent_positions;
+		// Slot in the world's table of each node, refreshed when an entity moved.
+		std::pmr::vector<entity_index> slots;
+		std::pmr::vector<uint8_t> dirty;
+		// Position in order by handle index
+		std::pmr::vector<entity_index> positions;
+		bool structure_changed{ true };
+	};
+}
@@ -2,6 +2,20 @@
 
 #include "ecs.h"
 
+#include "memory.h"
+
+#include "strings.h"
+
 #include "component_pool.h"
 
+#include "query.h"
+
 #include "world.h"
+
+#include "hierarchy.h"
+
+#include "serialize.h"
+
+#include "snapshot.h"
+
+#include "delta.h"
@@ -0,0 +1,369 @@
+#pragma once
+
+#include "ecs.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecs::detail {
+
+	// Open addressing hash map with linear probing for integer keys. Erase shifts
+	// the following entries back instead of leaving tombstones, so lookups never
+	// scan past deleted entries.
+	template<typename Key, typename Value>
+	struct flat_hash_map
+	{
+		static_assert(std::is_integral_v<Key>, "flat_hash_map keys must be integers");
+
+		explicit flat_hash_map(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			:slots(resource)
+		{}
+
+		const Value* find(Key key) const
+		{
+			if (count == 0)
+			{
+				return nullptr;
+			}
+
+			const auto index = probe(key);
+			return slots[index].used ? &slots[index].value : nullptr;
+		}
+
+		void insert_or_assign(Key key, Value value)
+		{
+			// Keep the table at most half full.
+			if ((count + 1) * 2 > slots.size()) [[unlikely]]
+			{
+				rehash(std::max<size_t>(64, slots.size() * 2));
+			}
+
+			auto& slot = slots[probe(key)];
+			if (!slot.used)
+			{
+				slot.used = true;
+				slot.key = key;
+				count++;
+			}
+			slot.value = value;
+		}
+
+		bool erase(Key key)
+		{
+			if (count == 0)
+			{
+				return false;
+			}
+
+			auto hole = probe(key);
+			if (!slots[hole].used)
+			{
+				return false;
+			}
+
+			const auto mask = slots.size() - 1;
+			for (auto next = (hole + 1) & mask; slots[next].used; next = (next + 1) & mask)
+			{
+				// Move next into the hole unless its home lies cyclically in (hole, next].
+				const auto home = ideal(slots[next].key);
+				const bool stays = hole < next ? (home > hole && home <= next) : (home > hole || home <= next);
+				if (!stays)
+				{
+					slots[hole] = slots[next];
+					hole = next;
+				}
+			}
+
+			slots[hole].used = false;
+			count--;
+			return true;
+		}
+
+		void clear()
+		{
+			std::fill(slots.begin(), slots.end(), slot{});
+			count = 0;
+		}
+
+		size_t size() const
+		{
+			return count;
+		}
+
+	private:
+		struct slot
+		{
+			Key key{};
+			Value value{};
+			bool used{ false };
+		};
+
+		size_t ideal(Key key) const
+		{
+			auto hash = static_cast<uint64_t>(key) * 0x9e3779b97f4a7c15ull;
+			return static_cast<size_t>(hash ^ (hash >> 32)) & (slots.size() - 1);
+		}
+
+		// Returns the slot holding key or the free slot it would go in.
+		size_t probe(Key key) const
+		{
+			const auto mask = slots.size() - 1;
+			auto index = ideal(key);
+			while (slots[index].used && slots[index].key != key)
+			{
+				index = (index + 1) & mask;
+			}
+			return index;
+		}
+
+		void rehash(size_t slot_count)
+		{
+			auto old = std::move(slots);
+			slots = std::pmr::vector<slot>(slot_count, old.get_allocator());
+			count = 0;
+			for (const auto& entry : old)
+			{
+				if (entry.used)
+				{
+					insert_or_assign(entry.key, entry.value);
+				}
+			}
+		}
+
+		std::pmr::vector<slot> slots;
+		size_t count{ 0 };
+	};
+
+	// Entities by integer key, any number of entities may share a key. Erase searches
+	// the entities of its key, so it suits keys few entities share, like names.
+	struct entity_multimap
+	{
+		explicit entity_multimap(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			:lookup(resource), buckets(resource)
+		{}
+
+		void insert(uint32_t key, entity_id entity)
+		{
+			auto bucket = lookup.find(key);
+			if (!bucket)
+			{
+				lookup.insert_or_assign(key, static_cast<uint32_t>(buckets.size()));
+				buckets.emplace_back();
+				bucket = lookup.find(key);
+			}
+			buckets[*bucket].push_back(entity);
+		}
+
+		void erase(uint32_t key, entity_id entity)
+		{
+			const auto bucket = lookup.find(key);
+			if (!bucket)
+			{
+				return;
+			}
+
+			auto& entities = buckets[*bucket];
+			if (const auto found = std::find(entities.begin(), entities.end(), entity); found != entities.end())
+			{
+				*found = entities.back();
+				entities.pop_back();
+			}
+		}
+
+		// Any one of the entities with key, INVALID_ENTITY if there are none.
+		entity_id find(uint32_t key) const
+		{
+			const auto bucket = lookup.find(key);
+			return bucket && !buckets[*bucket].empty() ? buckets[*bucket].front() : INVALID_ENTITY;
+		}
+
+		void clear()
+		{
+			lookup.clear();
+			buckets.clear();
+		}
+
+	private:
+		// Keys no entity has any more keep their bucket for reuse.
+		flat_hash_map<uint32_t, uint32_t> lookup;
+		std::pmr::vector<std::pmr::vector<entity_id>> buckets;
+	};
+
+	template<typename T, auto Field>
+	using field_type = std::remove_cvref_t<decltype(std::declval<T&>().*Field)>;
+
+	// Hashed indices key on the bits of the field.
+	template<typename Key>
+	uint64_t index_key(const Key& key)
+	{
+		static_assert(std::is_trivially_copyable_v<Key> && sizeof(Key) <= sizeof(uint64_t), "Hashed index keys must be trivially copyable and at most 8 bytes");
+
+		uint64_t bits = 0;
+		std::memcpy(&bits, &key, sizeof(Key));
+		return bits;
+	}
+}
+
+namespace ecs {
+
+	// Secondary indices over a field of a component, registered with
+	// world::register_index and kept up to date as the component is added, removed
+	// or changed through world::patch. Don't add, remove or patch the component
+	// from inside a for_each callback.
+
+	// Finds the entities whose field equals a key.
+	template<ECS_COMPONENT T, auto Field>
+	struct hashed_index
+	{
+		using component_type = T;
+		using key_type = detail::field_type<T, Field>;
+		constexpr static auto field = Field;
+
+		explicit hashed_index(std::pmr::memory_resource* resource)
+			:lookup(resource), buckets(resource), positions(resource)
+		{}
+
+		void insert(const key_type& key, entity_id entity)
+		{
+			const auto bits = detail::index_key(key);
+			auto bucket = lookup.find(bits);
+			if (!bucket)
+			{
+				lookup.insert_or_assign(bits, static_cast<uint32_t>(buckets.size()));
+				buckets.emplace_back();
+				bucket = lookup.find(bits);
+			}
+
+			const auto handle = get_entity_index(entity);
+			if (positions.size() <= handle)
+			{
+				positions.resize(handle + 1, INVALID_ENTITY_INDEX);
+			}
+
+			auto& entities = buckets[*bucket];
+			positions[handle] = static_cast<entity_index>(entities.size());
+			entities.push_back(entity);
+		}
+
+		void erase(const key_type& key, entity_id entity)
+		{
+			const auto bucket = lookup.find(detail::index_key(key));
+			if (!bucket)
+			{
+				return;
+			}
+
+			auto& entities = buckets[*bucket];
+			const auto handle = get_entity_index(entity);
+			const auto position = positions[handle];
+			const auto last = entities.back();
+
+			entities[position] = last;
+			positions[get_entity_index(last)] = position;
+			entities.pop_back();
+			positions[handle] = INVALID_ENTITY_INDEX;
+		}
+
+		size_t count(const key_type& key) const
+		{
+			const auto bucket = lookup.find(detail::index_key(key));
+			return bucket ? buckets[*bucket].size() : 0;
+		}
+
+		template<typename Func>
+		void for_each_equal(const key_type& key, Func&& func) const
+		{
+			if (const auto bucket = lookup.find(detail::index_key(key)))
+			{
+				for (const auto entity : buckets[*bucket])
+				{
+					func(entity);
+				}
+			}
+		}
+
+		void clear()
+		{
+			lookup.clear();
+			buckets.clear();
+			positions.clear();
+		}
+
+	private:
+		// Key bits to bucket, buckets of keys no entity has any more are kept for reuse.
+		detail::flat_hash_map<uint64_t, uint32_t> lookup;
+		std::pmr::vector<std::pmr::vector<entity_id>> buckets;
+		// Position in its bucket by handle index
+		std::pmr::vector<entity_index> positions;
+	};
+
+	// Keeps entities sorted by field for range queries. The field must be ordered by <.
+	template<ECS_COMPONENT T, auto Field>
+	struct ordered_index
+	{
+		using component_type = T;
+		using key_type = detail::field_type<T, Field>;
+		constexpr static auto field = Field;
+
+		explicit ordered_index(std::pmr::memory_resource* resource)
+			:entries(resource)
+		{}
+
+		void insert(const key_type& key, entity_id entity)
+		{
+			entries.emplace(key, entity);
+		}
+
+		void erase(const key_type& key, entity_id entity)
+		{
+			entries.erase({ key, entity });
+		}
+
+		// Calls func with every entity whose field lies in [first, last), in key order.
+		template<typename Func>
+		void for_each_in_range(const key_type& first, const key_type& last, Func&& func) const
+		{
+			for (auto entry = entries.lower_bound({ first, 0 }); entry != entries.end() && entry->first < last; ++entry)
+			{
+				func(entry->second);
+			}
+		}
+
+		template<typename Func>
+		void for_each_below(const key_type& last, Func&& func) const
+		{
+			for (auto entry = entries.begin(); entry != entries.end() && entry->first < last; ++entry)
+			{
+				func(entry->second);
+			}
+		}
+
+		template<typename Func>
+		void for_each_at_least(const key_type& first, Func&& func) const
+		{
+			for (auto entry = entries.lower_bound({ first, 0 }); entry != entries.end(); ++entry)
+			{
+				func(entry->second);
+			}
+		}
+
+		size_t size() const
+		{
+			return entries.size();
+		}
+
+		void clear()
+		{
+			entries.clear();
+		}
+
+	private:
+		std::pmr::set<std::pair<key_type, entity_id>> entries;
+	};
+}
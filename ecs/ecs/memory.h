@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ecs {
+
+	// Hands out whole 2MB pages, backed by huge/large pages when the OS grants them
+	// and by regular pages otherwise. Every allocation rounds up to a full page,
+	// so use it as the upstream of an arena rather than directly.
+	struct huge_page_resource : std::pmr::memory_resource
+	{
+		constexpr static size_t page_size = 2 * 1024 * 1024;
+
+		static size_t round_up(size_t bytes)
+		{
+			return (bytes + page_size - 1) & ~(page_size - 1);
+		}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			if (alignment > page_size) [[unlikely]]
+			{
+				throw std::bad_alloc();
+			}
+
+			const auto size = round_up(bytes);
+			void* memory = nullptr;
+#if defined(_WIN32)
+			if (GetLargePageMinimum() != 0)
+			{
+				memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			}
+			if (!memory)
+			{
+				memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			}
+#else
+#if defined(MAP_HUGETLB)
+			memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+			if (!memory || memory == MAP_FAILED)
+			{
+				// Over-map so the region can be trimmed to page_size alignment,
+				// which lets transparent huge pages back it.
+				const auto mapped = static_cast<uint8_t*>(mmap(nullptr, size + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+				if (mapped == MAP_FAILED)
+				{
+					throw std::bad_alloc();
+				}
+
+				const auto aligned = reinterpret_cast<uint8_t*>(round_up(reinterpret_cast<uintptr_t>(mapped)));
+				if (aligned != mapped)
+				{
+					munmap(mapped, aligned - mapped);
+				}
+				munmap(aligned + size, mapped + page_size - aligned);
+				memory = aligned;
+#if defined(MADV_HUGEPAGE)
+				madvise(memory, size, MADV_HUGEPAGE);
+#endif
+			}
+#endif
+			if (!memory)
+			{
+				throw std::bad_alloc();
+			}
+			return memory;
+		}
+
+		void do_deallocate(void* memory, size_t bytes, size_t) override
+		{
+#if defined(_WIN32)
+			VirtualFree(memory, 0, MEM_RELEASE);
+#else
+			munmap(memory, round_up(bytes));
+#endif
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	namespace detail {
+
+		template<typename T>
+		struct resource_deleter
+		{
+			void operator()(T* object) const
+			{
+				object->~T();
+				resource->deallocate(object, sizeof(T), alignof(T));
+			}
+
+			std::pmr::memory_resource* resource{ nullptr };
+		};
+
+		template<typename T>
+		using resource_ptr = std::unique_ptr<T, resource_deleter<T>>;
+
+		template<typename T, typename... Args>
+		resource_ptr<T> make_resource_ptr(std::pmr::memory_resource* resource, Args&&... args)
+		{
+			const auto memory = resource->allocate(sizeof(T), alignof(T));
+			return resource_ptr<T>(::new(memory) T(std::forward<Args>(args)...), resource_deleter<T>{ resource });
+		}
+
+		// Raw byte buffer released back to the resource it came from.
+		struct buffer_deleter
+		{
+			void operator()(uint8_t* memory) const
+			{
+				resource->deallocate(memory, size, alignment);
+			}
+
+			std::pmr::memory_resource* resource{ nullptr };
+			size_t size{ 0 };
+			size_t alignment{ 0 };
+		};
+
+		using buffer_ptr = std::unique_ptr<uint8_t[], buffer_deleter>;
+
+		inline buffer_ptr allocate_buffer(std::pmr::memory_resource* resource, size_t size, size_t alignment = alignof(std::max_align_t))
+		{
+			const auto memory = static_cast<uint8_t*>(resource->allocate(size, alignment));
+			return buffer_ptr(memory, buffer_deleter{ resource, size, alignment });
+		}
+
+		// Reserves address space without backing it, size must be a multiple of the page size.
+		inline uint8_t* reserve_virtual(size_t size)
+		{
+#if defined(_WIN32)
+			const auto memory = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+			if (!memory)
+			{
+				throw std::bad_alloc();
+			}
+#else
+			const auto memory = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (memory == MAP_FAILED)
+			{
+				throw std::bad_alloc();
+			}
+#endif
+			return static_cast<uint8_t*>(memory);
+		}
+
+		inline void commit_virtual(uint8_t* address, size_t size)
+		{
+#if defined(_WIN32)
+			if (!VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE))
+			{
+				throw std::bad_alloc();
+			}
+#else
+			if (mprotect(address, size, PROT_READ | PROT_WRITE) != 0)
+			{
+				throw std::bad_alloc();
+			}
+#endif
+		}
+
+		struct virtual_deleter
+		{
+			void operator()(uint8_t* memory) const
+			{
+#if defined(_WIN32)
+				VirtualFree(memory, 0, MEM_RELEASE);
+#else
+				munmap(memory, size);
+#endif
+			}
+
+			size_t size{ 0 };
+		};
+
+		using virtual_ptr = std::unique_ptr<uint8_t[], virtual_deleter>;
+	
+		// Read only view of a whole file.
+		struct mapped_file
+		{
+			mapped_file(const char* path)
+			{
+#if defined(_WIN32)
+				file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				LARGE_INTEGER file_size{};
+				if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+				{
+					return;
+				}
+
+				mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping)
+				{
+					memory = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+					length = memory ? static_cast<size_t>(file_size.QuadPart) : 0;
+				}
+#else
+				descriptor = open(path, O_RDONLY);
+				struct stat info{};
+				if (descriptor < 0 || fstat(descriptor, &info) != 0 || info.st_size == 0)
+				{
+					return;
+				}
+
+				const auto view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+				if (view != MAP_FAILED)
+				{
+					memory = static_cast<const uint8_t*>(view);
+					length = static_cast<size_t>(info.st_size);
+				}
+#endif
+			}
+
+			~mapped_file()
+			{
+#if defined(_WIN32)
+				if (memory)
+				{
+					UnmapViewOfFile(memory);
+				}
+				if (mapping)
+				{
+					CloseHandle(mapping);
+				}
+				if (file != INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(file);
+				}
+#else
+				if (memory)
+				{
+					munmap(const_cast<uint8_t*>(memory), length);
+				}
+				if (descriptor >= 0)
+				{
+					close(descriptor);
+				}
+#endif
+			}
+
+			mapped_file(const mapped_file&) = delete;
+			mapped_file& operator=(const mapped_file&) = delete;
+
+			bool is_open() const
+			{
+				return memory != nullptr;
+			}
+
+			// Maps size bytes of the file at offset copy-on-write over address, which must
+			// be page aligned like offset. Returns false where the OS can't place views
+			// inside an existing reservation, callers then copy instead.
+			bool map_at(uint8_t* address, size_t offset, size_t size) const
+			{
+#if defined(_WIN32)
+				return false;
+#else
+				return mmap(address, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, descriptor, offset) != MAP_FAILED;
+#endif
+			}
+
+			const uint8_t* memory{ nullptr };
+			size_t length{ 0 };
+
+		private:
+#if defined(_WIN32)
+			HANDLE file{ INVALID_HANDLE_VALUE };
+			HANDLE mapping{ nullptr };
+#else
+			int descriptor{ -1 };
+#endif
+		};
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ecs.h"
+
+#include <memory_resource>
+#include <vector>
+
+namespace ecs::detail {
+
+	// Dense list of the entities matching the masks, kept up to date by the world
+	// whenever an entity mask changes.
+	struct cached_query
+	{
+		cached_query(component_mask mask, component_mask excluded, std::pmr::memory_resource* resource)
+			:mask(mask), excluded(excluded), entities(resource), positions(resource)
+		{}
+
+		bool matches(const component_mask& entity_mask) const
+		{
+			return mask == (mask & entity_mask) && (excluded & entity_mask).none();
+		}
+
+		void update(entity_id entity, const component_mask& old_mask, const component_mask& new_mask)
+		{
+			const bool matched = matches(old_mask);
+			if (matched == matches(new_mask))
+			{
+				return;
+			}
+
+			if (matched)
+			{
+				erase(entity);
+			}
+			else
+			{
+				insert(entity);
+			}
+		}
+
+		void insert(entity_id entity)
+		{
+			const auto handle = get_entity_index(entity);
+			if (positions.size() <= handle)
+			{
+				positions.resize(handle + 1, INVALID_ENTITY_INDEX);
+			}
+
+			positions[handle] = static_cast<entity_index>(entities.size());
+			entities.push_back(entity);
+		}
+
+		void erase(entity_id entity)
+		{
+			const auto handle = get_entity_index(entity);
+			const auto position = positions[handle];
+			const auto last = entities.back();
+
+			entities[position] = last;
+			positions[get_entity_index(last)] = position;
+			entities.pop_back();
+			positions[handle] = INVALID_ENTITY_INDEX;
+		}
+
+		component_mask mask;
+		component_mask excluded;
+		std::pmr::vector<entity_id> entities;
+		// Position in entities by handle index
+		std::pmr::vector<entity_index> positions;
+	};
+}
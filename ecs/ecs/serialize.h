@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ecs {
+
+	namespace detail {
+		// Lets string keyed maps be searched with a string_view without a temporary string.
+		struct string_hash
+		{
+			using is_transparent = void;
+
+			size_t operator()(std::string_view text) const
+			{
+				return std::hash<std::string_view>{}(text);
+			}
+		};
+	}
+
+	// Deduplicated strings, each stored once as a uint32_t length followed by its bytes.
+	// Strings are referred to by the offset of their length prefix.
+	struct string_table
+	{
+		uint32_t add(std::string_view text)
+		{
+			if (const auto found = offsets.find(text); found != offsets.end())
+			{
+				return found->second;
+			}
+
+			const auto offset = static_cast<uint32_t>(bytes.size());
+			const auto length = static_cast<uint32_t>(text.size());
+			const auto prefix = reinterpret_cast<const uint8_t*>(&length);
+			bytes.insert(bytes.end(), prefix, prefix + sizeof(length));
+			bytes.insert(bytes.end(), text.begin(), text.end());
+			offsets.emplace(text, offset);
+			return offset;
+		}
+
+		void clear()
+		{
+			bytes.clear();
+			offsets.clear();
+		}
+
+		std::vector<uint8_t> bytes;
+		std::unordered_map<std::string, uint32_t, detail::string_hash, std::equal_to<>> offsets;
+	};
+
+	// Read side of a string_table, over bytes owned by someone else.
+	struct string_table_view
+	{
+		// Out of range offsets read as an empty string.
+		std::string_view get(uint32_t offset) const
+		{
+			uint32_t length = 0;
+			if (uint64_t(offset) + sizeof(length) > size)
+			{
+				return {};
+			}
+
+			std::memcpy(&length, data + offset, sizeof(length));
+			if (uint64_t(offset) + sizeof(length) + length > size)
+			{
+				return {};
+			}
+			return std::string_view(reinterpret_cast<const char*>(data + offset + sizeof(length)), length);
+		}
+
+		const uint8_t* data{ nullptr };
+		uint64_t size{ 0 };
+	};
+
+	// Trivially copyable components are serialized as raw pool memory. Any other
+	// component specializes serializer to be streamed instead, each one encoded to a
+	// trivially copyable encoded_type, with owned strings moved into a string_table:
+	//
+	//	template<> struct ecs::serializer<T>
+	//	{
+	//		using encoded_type = ...;
+	//		static encoded_type encode(const T& component, ecs::string_table& strings);
+	//		static T decode(const encoded_type& value, const ecs::string_table_view& strings);
+	//	};
+	template<typename T>
+	struct serializer {};
+
+	namespace detail {
+		template<typename T, typename = void>
+		struct is_streamed : std::false_type {};
+
+		template<typename T>
+		struct is_streamed<T, std::void_t<typename serializer<T>::encoded_type>> : std::true_type {};
+
+		template<typename T>
+		constexpr bool is_streamed_v = is_streamed<T>::value;
+
+		template<typename T>
+		constexpr bool is_serializable_v = std::is_trivially_copyable_v<T> || is_streamed_v<T>;
+	}
+}
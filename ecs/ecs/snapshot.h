@@ -0,0 +1,781 @@
+#pragma once
+
+#include "ecs.h"
+#include "memory.h"
+#include "serialize.h"
+#include "world.h"
+
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ecs {
+
+	namespace detail {
+		constexpr uint64_t fnv1a(std::string_view text, uint64_t hash = 14695981039346656037ull)
+		{
+			for (const auto c : text)
+			{
+				hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+			}
+			return hash;
+		}
+
+		template<typename T>
+		constexpr std::string_view type_name()
+		{
+#if defined(_MSC_VER)
+			return __FUNCSIG__;
+#else
+			return __PRETTY_FUNCTION__;
+#endif
+		}
+
+		template<typename T, typename = void>
+		struct schema_version
+		{
+			constexpr static uint64_t value = 0;
+		};
+
+		template<typename T>
+		struct schema_version<T, std::void_t<decltype(T::schema_version)>>
+		{
+			constexpr static uint64_t value = T::schema_version;
+		};
+
+		// Size of one element of a pool in the snapshot, streamed components store their encoded_type.
+		template<typename T>
+		constexpr size_t snapshot_stride()
+		{
+			if constexpr (is_streamed_v<T>)
+			{
+				return sizeof(typename serializer<T>::encoded_type);
+			}
+			else
+			{
+				return component_stride<T>();
+			}
+		}
+
+		// Identifies a component layout between builds of the same compiler. Changes with the
+		// type's name, stride and alignment, bump a static schema_version member for anything else.
+		// Streamed components only hash their encoded stride, their in memory layout doesn't matter.
+		template<typename T>
+		constexpr uint64_t schema_hash()
+		{
+			auto hash = fnv1a(type_name<T>());
+			hash = (hash ^ snapshot_stride<T>()) * 1099511628211ull;
+			if constexpr (!is_streamed_v<T>)
+			{
+				hash = (hash ^ component_alignment<T>()) * 1099511628211ull;
+			}
+			return (hash ^ schema_version<T>::value) * 1099511628211ull;
+		}
+
+		constexpr uint32_t snapshot_magic = 0x53534345; // "ECSS"
+		constexpr uint32_t snapshot_version = 2;
+
+		// Pool data starts on this boundary in the file, so virtual pools can map it directly.
+		constexpr size_t snapshot_alignment = component_pool<virtual_storage_t>::chunk_size;
+
+		constexpr size_t snapshot_align(size_t offset)
+		{
+			return (offset + snapshot_alignment - 1) & ~(snapshot_alignment - 1);
+		}
+
+		struct snapshot_header
+		{
+			uint32_t magic{ snapshot_magic };
+			uint32_t version{ snapshot_version };
+			uint32_t entity_count{ 0 };
+			uint32_t handle_count{ 0 };
+			uint32_t free_head{ 0 };
+			uint32_t free_tail{ 0 };
+			uint32_t free_count{ 0 };
+			uint32_t pool_count{ 0 };
+		};
+
+		struct snapshot_entity
+		{
+			entity_id id{};
+			uint32_t mask{ 0 };
+			uint32_t padding{ 0 };
+		};
+
+		struct snapshot_pool
+		{
+			uint64_t schema{ 0 };
+			// Component id in the saving process, masks are remapped on load
+			uint32_t component_id{ 0 };
+			uint32_t stride{ 0 };
+			uint64_t offset{ 0 };
+			uint64_t size{ 0 };
+		};
+
+		// Small pools are stored as their index mapping followed by the raw storage.
+		struct snapshot_small_pool
+		{
+			uint64_t count{ 0 };
+			uint64_t mapping[small_storage_t::size]{};
+		};
+
+		template<ECS_COMPONENT T>
+		uint64_t snapshot_pool_size(const ecs::world& world)
+		{
+			if constexpr (std::is_same_v<typename T::storage_type, small_storage_t>)
+			{
+				return sizeof(snapshot_small_pool) + component_stride<T>() * small_storage_t::size;
+			}
+			else
+			{
+				return uint64_t(world.scan_end) * component_stride<T>();
+			}
+		}
+
+		struct file_sink
+		{
+			void write(const void* data, uint64_t size)
+			{
+				file.write(static_cast<const char*>(data), size);
+			}
+
+			std::ofstream& file;
+		};
+
+		struct buffer_sink
+		{
+			void write(const void* data, uint64_t size)
+			{
+				const auto bytes = static_cast<const uint8_t*>(data);
+				buffer.insert(buffer.end(), bytes, bytes + size);
+			}
+
+			std::vector<uint8_t>& buffer;
+		};
+
+		template<typename Sink>
+		void write_padding(Sink& sink, uint64_t size)
+		{
+			static const uint8_t zeros[4096]{};
+			while (size > 0)
+			{
+				const auto chunk = std::min<uint64_t>(size, sizeof(zeros));
+				sink.write(zeros, chunk);
+				size -= chunk;
+			}
+		}
+
+		// Places each pool's data on an aligned offset after the tables, returns the total size.
+		inline uint64_t layout_snapshot(const snapshot_header& header, std::vector<snapshot_pool>& records)
+		{
+			uint64_t offset = snapshot_align(sizeof(header)
+				+ uint64_t(header.entity_count) * sizeof(snapshot_entity)
+				+ uint64_t(header.handle_count) * sizeof(ecs::world::entity_handle)
+				+ uint64_t(header.pool_count) * sizeof(snapshot_pool));
+			for (auto& record : records)
+			{
+				record.offset = offset;
+				offset = snapshot_align(offset + record.size);
+			}
+			return offset;
+		}
+
+		// Validated pointers into a snapshot held in memory.
+		struct snapshot_view
+		{
+			bool parse(const uint8_t* memory, size_t length)
+			{
+				if (!memory || length < sizeof(header))
+				{
+					return false;
+				}
+
+				std::memcpy(&header, memory, sizeof(header));
+				if (header.magic != snapshot_magic || header.version != snapshot_version
+					|| header.entity_count > MAX_ENTITIES || header.handle_count > MAX_ENTITIES || header.pool_count > MAX_COMPONENTS)
+				{
+					return false;
+				}
+
+				data = memory;
+				entities = memory + sizeof(header);
+				handles = entities + uint64_t(header.entity_count) * sizeof(snapshot_entity);
+				const auto directory = handles + uint64_t(header.handle_count) * sizeof(ecs::world::entity_handle);
+				if (directory + uint64_t(header.pool_count) * sizeof(snapshot_pool) > memory + length)
+				{
+					return false;
+				}
+
+				pools.resize(header.pool_count);
+				std::memcpy(pools.data(), directory, pools.size() * sizeof(snapshot_pool));
+				for (const auto& record : pools)
+				{
+					if (record.component_id >= MAX_COMPONENTS || record.offset > length || record.size > length - record.offset)
+					{
+						return false;
+					}
+				}
+				return check_handles();
+			}
+
+			const snapshot_pool* find_pool(uint64_t schema) const
+			{
+				for (const auto& record : pools)
+				{
+					if (record.schema == schema)
+					{
+						return &record;
+					}
+				}
+				return nullptr;
+			}
+
+			snapshot_entity entity_at(entity_index slot) const
+			{
+				snapshot_entity entity;
+				std::memcpy(&entity, entities + uint64_t(slot) * sizeof(entity), sizeof(entity));
+				return entity;
+			}
+
+			ecs::world::entity_handle handle_at(entity_index index) const
+			{
+				ecs::world::entity_handle handle;
+				std::memcpy(&handle, handles + uint64_t(index) * sizeof(handle), sizeof(handle));
+				return handle;
+			}
+
+			// Every live entity must own its handle and the free list must stay inside the
+			// handle table, the loaded world indexes its tables through them unchecked.
+			bool check_handles() const
+			{
+				for (entity_index slot = 0; slot < header.entity_count; ++slot)
+				{
+					const auto entity = entity_at(slot);
+					if (!is_entity_valid(entity.id))
+					{
+						// The world keeps the last slot below scan_end alive.
+						if (slot + 1 == header.entity_count)
+						{
+							return false;
+						}
+						continue;
+					}
+
+					const auto index = get_entity_index(entity.id);
+					if (index >= header.handle_count)
+					{
+						return false;
+					}
+
+					const auto handle = handle_at(index);
+					if (handle.slot != slot || handle.version != get_entity_version(entity.id))
+					{
+						return false;
+					}
+				}
+
+				if (header.free_count > header.handle_count)
+				{
+					return false;
+				}
+
+				auto index = header.free_head;
+				for (uint32_t count = 0; count < header.free_count; ++count)
+				{
+					if (index >= header.handle_count)
+					{
+						return false;
+					}
+
+					// A handle owned by a live entity can't be free.
+					const auto handle = handle_at(index);
+					if (handle.slot < header.entity_count && entity_at(handle.slot).id == create_entity_id(index, handle.version))
+					{
+						return false;
+					}
+
+					if (count + 1 == header.free_count)
+					{
+						return index == header.free_tail && handle.next_free == INVALID_ENTITY_INDEX;
+					}
+					index = handle.next_free;
+				}
+				return true;
+			}
+
+			snapshot_header header;
+			std::vector<snapshot_pool> pools;
+			const uint8_t* data{ nullptr };
+			const uint8_t* entities{ nullptr };
+			const uint8_t* handles{ nullptr };
+		};
+
+		// Slots without the component are written as zeros, their storage holds stale or
+		// uninitialized bytes, and for virtual pools may not even be committed.
+		template<ECS_COMPONENT T, typename Sink>
+		void write_pool(Sink& file, ecs::world& world, ecs::world::pools& pool, uint64_t size)
+		{
+			using storage_type = typename T::storage_type;
+			auto& typed_pool = std::get<ecs::world::pool_t<storage_type>>(pool);
+			constexpr auto stride = component_stride<T>();
+			const auto component_id = type_id<T>();
+			const auto has_component = [&](uint64_t slot)
+			{
+				return slot < world.scan_end && world.entities[slot].mask.test(component_id);
+			};
+
+			if constexpr (std::is_same_v<storage_type, small_storage_t>)
+			{
+				snapshot_small_pool header;
+				header.count = std::min<uint64_t>(typed_pool.index_mapping.size(), small_storage_t::size);
+				std::copy_n(typed_pool.index_mapping.begin(), header.count, header.mapping);
+				file.write(&header, sizeof(header));
+				for (uint64_t index = 0; index < small_storage_t::size; ++index)
+				{
+					if (index < header.count && has_component(header.mapping[index]))
+					{
+						file.write(typed_pool.storage.get() + index * stride, stride);
+					}
+					else
+					{
+						write_padding(file, stride);
+					}
+				}
+			}
+			else
+			{
+				// Runs of slots that all have, or all lack, the component
+				const auto count = size / stride;
+				for (uint64_t first = 0; first < count;)
+				{
+					const bool present = has_component(first);
+					auto last = first + 1;
+					while (last < count && has_component(last) == present)
+					{
+						last++;
+					}
+
+					if (present)
+					{
+						file.write(typed_pool.get(first), (last - first) * stride);
+					}
+					else
+					{
+						write_padding(file, (last - first) * stride);
+					}
+					first = last;
+				}
+			}
+		}
+
+		// Checks a pool record against this build's layout of T, read_pool copies or maps
+		// record.size bytes into storage sized for that layout. Small pools also bound the
+		// count of their index mapping.
+		template<ECS_COMPONENT T>
+		bool pool_fits(const snapshot_view& snapshot, const snapshot_pool& record)
+		{
+			constexpr auto stride = component_stride<T>();
+			if constexpr (std::is_same_v<typename T::storage_type, small_storage_t>)
+			{
+				if (record.size != sizeof(snapshot_small_pool) + stride * small_storage_t::size)
+				{
+					return false;
+				}
+
+				uint64_t count = 0;
+				std::memcpy(&count, snapshot.data + record.offset, sizeof(count));
+				return count <= small_storage_t::size;
+			}
+			else
+			{
+				return record.size == uint64_t(snapshot.header.entity_count) * stride;
+			}
+		}
+
+		// file is only set when the snapshot is a mapped file, which lets virtual pools map it.
+		template<ECS_COMPONENT T>
+		void read_pool(ecs::world& world, const snapshot_view& snapshot, const mapped_file* file, const snapshot_pool& record)
+		{
+			using storage_type = typename T::storage_type;
+			auto& pool = world.create_pool<T>(type_id<T>());
+			const auto data = snapshot.data + record.offset;
+
+			if constexpr (std::is_same_v<storage_type, small_storage_t>)
+			{
+				snapshot_small_pool header;
+				std::memcpy(&header, data, sizeof(header));
+				pool.index_mapping.assign(header.mapping, header.mapping + header.count);
+				std::memcpy(pool.storage.get(), data + sizeof(header), record.size - sizeof(header));
+			}
+			else if constexpr (std::is_same_v<storage_type, virtual_storage_t>)
+			{
+				constexpr auto chunk_size = component_pool<virtual_storage_t>::chunk_size;
+				const auto mapped_size = snapshot_align(record.size);
+
+				// Only map what the file holds, pages past its end fault on access.
+				if (file && mapped_size > 0 && record.offset + mapped_size <= file->length
+					&& file->map_at(pool.storage.get(), record.offset, mapped_size))
+				{
+					for (size_t chunk = 0; chunk < mapped_size / chunk_size; ++chunk)
+					{
+						if (!pool.committed_chunks[chunk])
+						{
+							pool.committed_chunks[chunk] = true;
+							pool.committed += chunk_size;
+						}
+					}
+				}
+				else
+				{
+					for (size_t index = 0; index < record.size / record.stride; ++index)
+					{
+						pool.commit(index);
+					}
+					std::memcpy(pool.storage.get(), data, record.size);
+				}
+			}
+			else
+			{
+				std::memcpy(pool.storage.get(), data, record.size);
+			}
+		}
+
+		// Streamed pools hold one encoded_type per slot, zeroed where the entity lacks the
+		// component, followed by the string table as a uint32_t size and its bytes. The
+		// record is padded to a multiple of the stride so deltas still diff it per element.
+		template<ECS_COMPONENT T>
+		void encode_pool(ecs::world& world, std::vector<uint8_t>& out)
+		{
+			using encoded_type = typename serializer<T>::encoded_type;
+			static_assert(std::is_trivially_copyable_v<encoded_type>, "encoded_type must be trivially copyable");
+			static_assert(!std::is_same_v<typename T::storage_type, small_storage_t>, "Streamed components can't use small storage");
+
+			const auto component_id = type_id<T>();
+			constexpr auto stride = sizeof(encoded_type);
+			string_table strings;
+
+			out.assign(size_t(world.scan_end) * stride, 0);
+			for (entity_index slot = 0; slot < world.scan_end; ++slot)
+			{
+				const auto& entity = world.entities[slot];
+				if (is_entity_valid(entity.id) && entity.mask.test(component_id))
+				{
+					const encoded_type value = serializer<T>::encode(world.get_component<T>(entity.id), strings);
+					std::memcpy(out.data() + size_t(slot) * stride, &value, stride);
+				}
+			}
+
+			const auto table_size = static_cast<uint32_t>(strings.bytes.size());
+			const auto prefix = reinterpret_cast<const uint8_t*>(&table_size);
+			out.insert(out.end(), prefix, prefix + sizeof(table_size));
+			out.insert(out.end(), strings.bytes.begin(), strings.bytes.end());
+			out.resize((out.size() + stride - 1) / stride * stride, 0);
+		}
+
+		// Finds the string table of a streamed pool, false if the record is too short to hold it.
+		inline bool find_string_table(const snapshot_view& snapshot, const snapshot_pool& record, string_table_view& strings)
+		{
+			const auto table = uint64_t(snapshot.header.entity_count) * record.stride;
+			uint32_t table_size = 0;
+			if (table + sizeof(table_size) > record.size)
+			{
+				return false;
+			}
+
+			const auto data = snapshot.data + record.offset;
+			std::memcpy(&table_size, data + table, sizeof(table_size));
+			if (table + sizeof(table_size) + table_size > record.size)
+			{
+				return false;
+			}
+
+			strings.data = data + table + sizeof(table_size);
+			strings.size = table_size;
+			return true;
+		}
+
+		// Constructs a component for every loaded entity whose mask has T.
+		template<ECS_COMPONENT T>
+		void decode_pool(ecs::world& world, const snapshot_view& snapshot, const snapshot_pool& record)
+		{
+			using encoded_type = typename serializer<T>::encoded_type;
+			constexpr auto stride = sizeof(encoded_type);
+
+			string_table_view strings;
+			find_string_table(snapshot, record, strings);
+
+			const auto component_id = type_id<T>();
+			auto& pool = world.create_pool<T>(component_id);
+			const auto data = snapshot.data + record.offset;
+			for (entity_index slot = 0; slot < world.scan_end; ++slot)
+			{
+				const auto& entity = world.entities[slot];
+				if (!is_entity_valid(entity.id) || !entity.mask.test(component_id))
+				{
+					continue;
+				}
+
+				if constexpr (std::is_same_v<typename T::storage_type, virtual_storage_t>)
+				{
+					pool.commit(slot);
+				}
+
+				encoded_type value;
+				std::memcpy(&value, data + size_t(slot) * stride, stride);
+				::new(pool.get(slot)) T(serializer<T>::decode(value, strings));
+			}
+		}
+
+		template<ECS_COMPONENT... Ts, typename Sink>
+		void write_snapshot(ecs::world& world, Sink& sink)
+		{
+			static_assert((is_serializable_v<Ts> && ...), "Snapshot components must be trivially copyable or specialize ecs::serializer");
+
+			snapshot_header header;
+			header.entity_count = world.scan_end;
+			header.handle_count = static_cast<uint32_t>(world.handles.size());
+			header.free_head = world.free_head;
+			header.free_tail = world.free_tail;
+			header.free_count = world.free_count;
+
+			std::vector<snapshot_entity> entities(world.scan_end);
+			for (entity_index slot = 0; slot < world.scan_end; ++slot)
+			{
+				entities[slot].id = world.entities[slot].id;
+				entities[slot].mask = static_cast<uint32_t>(world.entities[slot].mask.to_ulong());
+			}
+
+			// Streamed pools are encoded up front, their size depends on the strings.
+			std::vector<snapshot_pool> records;
+			std::vector<std::vector<uint8_t>> streamed;
+			const auto add_record = [&](auto* component)
+			{
+				using T = std::remove_pointer_t<decltype(component)>;
+				const auto component_id = type_id<T>();
+				if (component_id >= world.component_pools.size() || !world.component_pools[component_id])
+				{
+					return;
+				}
+
+				auto& encoded = streamed.emplace_back();
+				uint64_t size = 0;
+				if constexpr (is_streamed_v<T>)
+				{
+					encode_pool<T>(world, encoded);
+					size = encoded.size();
+				}
+				else
+				{
+					size = snapshot_pool_size<T>(world);
+				}
+				records.push_back({ schema_hash<T>(), static_cast<uint32_t>(component_id), static_cast<uint32_t>(snapshot_stride<T>()), 0, size });
+			};
+			(add_record(static_cast<Ts*>(nullptr)), ...);
+			header.pool_count = static_cast<uint32_t>(records.size());
+
+			const auto total_size = layout_snapshot(header, records);
+
+			sink.write(&header, sizeof(header));
+			sink.write(entities.data(), entities.size() * sizeof(snapshot_entity));
+			sink.write(world.handles.data(), world.handles.size() * sizeof(ecs::world::entity_handle));
+			sink.write(records.data(), records.size() * sizeof(snapshot_pool));
+
+			uint64_t written = sizeof(header)
+				+ entities.size() * sizeof(snapshot_entity)
+				+ world.handles.size() * sizeof(ecs::world::entity_handle)
+				+ records.size() * sizeof(snapshot_pool);
+			// Records were added in the order of Ts, skipping components without a pool.
+			size_t next_record = 0;
+			const auto write_record = [&](auto* component)
+			{
+				using T = std::remove_pointer_t<decltype(component)>;
+				if (next_record == records.size() || records[next_record].schema != schema_hash<T>())
+				{
+					return;
+				}
+
+				const auto& record = records[next_record];
+				write_padding(sink, record.offset - written);
+				if constexpr (is_streamed_v<T>)
+				{
+					sink.write(streamed[next_record].data(), record.size);
+				}
+				else
+				{
+					write_pool<T>(sink, world, *world.component_pools[record.component_id], record.size);
+				}
+				written = record.offset + record.size;
+				next_record++;
+			};
+			(write_record(static_cast<Ts*>(nullptr)), ...);
+			write_padding(sink, total_size - written);
+		}
+
+		// Returns false, leaving world untouched, when a pool of Ts doesn't fit its layout.
+		template<ECS_COMPONENT... Ts>
+		bool read_snapshot(ecs::world& world, const snapshot_view& snapshot, const mapped_file* file)
+		{
+			static_assert((is_serializable_v<Ts> && ...), "Snapshot components must be trivially copyable or specialize ecs::serializer");
+
+			const auto fits = [&](auto* component)
+			{
+				using T = std::remove_pointer_t<decltype(component)>;
+				const auto record = snapshot.find_pool(schema_hash<T>());
+				if constexpr (is_streamed_v<T>)
+				{
+					return true;
+				}
+				else
+				{
+					return !record || record->stride != snapshot_stride<T>() || pool_fits<T>(snapshot, *record);
+				}
+			};
+			if (!(fits(static_cast<Ts*>(nullptr)) && ...))
+			{
+				return false;
+			}
+
+			world.clear();
+
+			// Component ids are handed out at runtime, translate the saved ones to ours.
+			component_mask remap[MAX_COMPONENTS];
+			const auto find_record = [&](auto* component) -> const snapshot_pool*
+			{
+				using T = std::remove_pointer_t<decltype(component)>;
+				const auto record = snapshot.find_pool(schema_hash<T>());
+				if (!record || record->stride != snapshot_stride<T>())
+				{
+					return nullptr;
+				}
+
+				string_table_view strings;
+				if constexpr (is_streamed_v<T>)
+				{
+					if (!find_string_table(snapshot, *record, strings))
+					{
+						return nullptr;
+					}
+				}
+				return record;
+			};
+			const auto map_pool = [&](auto* component)
+			{
+				using T = std::remove_pointer_t<decltype(component)>;
+				if (const auto record = find_record(component))
+				{
+					remap[record->component_id].set(type_id<T>());
+				}
+			};
+			(map_pool(static_cast<Ts*>(nullptr)), ...);
+
+			const auto& header = snapshot.header;
+			world.entities.resize(header.entity_count);
+			for (entity_index slot = 0; slot < header.entity_count; ++slot)
+			{
+				snapshot_entity entity;
+				std::memcpy(&entity, snapshot.entities + slot * sizeof(entity), sizeof(entity));
+
+				const component_mask saved_mask(entity.mask);
+				component_mask mask;
+				for (uint32_t component_id = 0; component_id < MAX_COMPONENTS; ++component_id)
+				{
+					if (saved_mask.test(component_id))
+					{
+						mask |= remap[component_id];
+					}
+				}
+				world.entities[slot] = { entity.id, mask };
+			}
+
+			world.handles.resize(header.handle_count);
+			std::memcpy(world.handles.data(), snapshot.handles, header.handle_count * sizeof(ecs::world::entity_handle));
+			world.free_head = header.free_head;
+			world.free_tail = header.free_tail;
+			world.free_count = header.free_count;
+			world.scan_end = header.entity_count;
+
+			// Streamed pools construct components by mask, so they load after the entity table.
+			const auto load_pool = [&](auto* component)
+			{
+				using T = std::remove_pointer_t<decltype(component)>;
+				if (const auto record = find_record(component))
+				{
+					if constexpr (is_streamed_v<T>)
+					{
+						decode_pool<T>(world, snapshot, *record);
+					}
+					else
+					{
+						read_pool<T>(world, snapshot, file, *record);
+					}
+				}
+			};
+			(load_pool(static_cast<Ts*>(nullptr)), ...);
+
+			world.rebuild();
+			return true;
+		}
+	}
+
+	// In memory snapshot, same layout as the file format.
+	struct snapshot
+	{
+		std::vector<uint8_t> bytes;
+	};
+
+	// Writes the entity table and the pools of Ts to path. The file is laid out so
+	// load_snapshot can map it and copy, or map, each trivially copyable pool with a
+	// single operation. Other components are streamed through ecs::serializer.
+	template<ECS_COMPONENT... Ts>
+	bool save_snapshot(ecs::world& world, const char* path)
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+		{
+			return false;
+		}
+
+		detail::file_sink sink{ file };
+		detail::write_snapshot<Ts...>(world, sink);
+		return file.good();
+	}
+
+	// Reuses the capacity of out, so keeping a ring of snapshots doesn't allocate per frame.
+	template<ECS_COMPONENT... Ts>
+	void save_snapshot(ecs::world& world, ecs::snapshot& out)
+	{
+		out.bytes.clear();
+		detail::buffer_sink sink{ out.bytes };
+		detail::write_snapshot<Ts...>(world, sink);
+	}
+
+	// Replaces the contents of world with the snapshot at path. Pools of Ts missing from
+	// the snapshot stay empty, and components in the snapshot but not in Ts are dropped.
+	// A corrupt snapshot is rejected and leaves world unchanged.
+	template<ECS_COMPONENT... Ts>
+	bool load_snapshot(ecs::world& world, const char* path)
+	{
+		const detail::mapped_file file(path);
+		detail::snapshot_view view;
+		if (!view.parse(file.memory, file.length))
+		{
+			return false;
+		}
+
+		return detail::read_snapshot<Ts...>(world, view, &file);
+	}
+
+	template<ECS_COMPONENT... Ts>
+	bool load_snapshot(ecs::world& world, const ecs::snapshot& snapshot)
+	{
+		detail::snapshot_view view;
+		if (!view.parse(snapshot.bytes.data(), snapshot.bytes.size()))
+		{
+			return false;
+		}
+
+		return detail::read_snapshot<Ts...>(world, view, nullptr);
+	}
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "memory.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace ecs {
+
+	// Handle of a string interned in a string_pool. Equal strings share a handle,
+	// so comparing two handles compares the strings.
+	struct string_handle
+	{
+		uint32_t value{ 0 };
+
+		friend bool operator==(string_handle, string_handle) = default;
+	};
+
+	// Interns strings and hands out 32-bit handles for them. Handle 0 is the empty
+	// string. Strings live until the pool is destroyed and never move, so views
+	// returned by get stay valid.
+	struct string_pool
+	{
+		explicit string_pool(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			:strings(resource), slots(resource), blocks(resource), resource(resource)
+		{
+			strings.push_back({ "", 0, hash("") });
+			rehash(64);
+		}
+
+		string_pool(const string_pool&) = delete;
+		string_pool& operator=(const string_pool&) = delete;
+
+		string_handle intern(std::string_view text)
+		{
+			const auto text_hash = hash(text);
+			auto slot = probe(text, text_hash);
+			if (slots[slot] != empty_slot)
+			{
+				return { slots[slot] };
+			}
+
+			// Keep the table at most half full.
+			if ((strings.size() + 1) * 2 > slots.size()) [[unlikely]]
+			{
+				rehash(slots.size() * 2);
+				slot = probe(text, text_hash);
+			}
+
+			const auto handle = static_cast<uint32_t>(strings.size());
+			strings.push_back({ store(text), static_cast<uint32_t>(text.size()), text_hash });
+			slots[slot] = handle;
+			return { handle };
+		}
+
+		// Returns the handle of text if it was interned, without interning it.
+		bool find(std::string_view text, string_handle& handle) const
+		{
+			const auto slot = probe(text, hash(text));
+			if (slots[slot] == empty_slot)
+			{
+				return false;
+			}
+
+			handle.value = slots[slot];
+			return true;
+		}
+
+		std::string_view get(string_handle handle) const
+		{
+			const auto& entry = strings[handle.value];
+			return std::string_view(entry.characters, entry.length);
+		}
+
+		size_t size() const
+		{
+			return strings.size();
+		}
+
+	private:
+		constexpr static uint32_t empty_slot = 0xffffffff;
+		constexpr static size_t block_size = 64 * 1024;
+
+		struct entry
+		{
+			const char* characters{ nullptr };
+			uint32_t length{ 0 };
+			size_t hash{ 0 };
+		};
+
+		static size_t hash(std::string_view text)
+		{
+			return std::hash<std::string_view>{}(text);
+		}
+
+		// Linear probing, returns the slot holding text or the empty slot it would go in.
+		size_t probe(std::string_view text, size_t text_hash) const
+		{
+			const auto mask = slots.size() - 1;
+			for (auto slot = text_hash & mask;; slot = (slot + 1) & mask)
+			{
+				const auto handle = slots[slot];
+				if (handle == empty_slot)
+				{
+					return slot;
+				}
+
+				const auto& entry = strings[handle];
+				if (entry.hash == text_hash && get({ handle }) == text)
+				{
+					return slot;
+				}
+			}
+		}
+
+		void rehash(size_t slot_count)
+		{
+			slots.assign(slot_count, empty_slot);
+			const auto mask = slot_count - 1;
+			for (uint32_t handle = 0; handle < strings.size(); ++handle)
+			{
+				auto slot = strings[handle].hash & mask;
+				while (slots[slot] != empty_slot)
+				{
+					slot = (slot + 1) & mask;
+				}
+				slots[slot] = handle;
+			}
+		}
+
+		// Copies text into block storage, strings longer than a block get their own.
+		const char* store(std::string_view text)
+		{
+			if (text.size() > block_remaining)
+			{
+				const auto size = std::max(block_size, text.size());
+				block = blocks.emplace_back(detail::allocate_buffer(resource, size, 1)).get();
+				block_remaining = size;
+			}
+
+			const auto characters = reinterpret_cast<char*>(block);
+			std::memcpy(characters, text.data(), text.size());
+			block += text.size();
+			block_remaining -= text.size();
+			return characters;
+		}
+
+		std::pmr::vector<entry> strings;
+		// Open addressing table of handles, power of two sized.
+		std::pmr::vector<uint32_t> slots;
+		std::pmr::vector<detail::buffer_ptr> blocks;
+		uint8_t* block{ nullptr };
+		size_t block_remaining{ 0 };
+		std::pmr::memory_resource* resource{ nullptr };
+	};
+
+	// Pool behind interned_string. Not thread safe, intern from one thread at a time.
+	inline string_pool& global_strings()
+	{
+		static string_pool pool;
+		return pool;
+	}
+
+	// Four byte, trivially copyable string for components. Constructing one interns
+	// the text in global_strings(), copies and comparisons only touch the handle.
+	struct interned_string
+	{
+		interned_string() = default;
+
+		interned_string(std::string_view text)
+			:handle(global_strings().intern(text))
+		{}
+
+		std::string_view view() const
+		{
+			return global_strings().get(handle);
+		}
+
+		friend bool operator==(interned_string, interned_string) = default;
+
+		string_handle handle;
+	};
+}
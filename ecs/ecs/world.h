@@ -1,13 +1,31 @@
 #pragma once
 
 #include "ecs.h"
+#include "index.h"
+#include "memory.h"
+#include "query.h"
+#include "strings.h"
 
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <tuple>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
 namespace ecs {
 	
 	namespace detail {
+		// Unique address per type, unlike type_id it works for any type.
+		template<typename T>
+		const void* type_tag()
+		{
+			static const char tag{};
+			return &tag;
+		}
+
 		inline int counter = 0;
 		template <ECS_COMPONENT T>
 		__forceinline static int type_id()
@@ -19,6 +37,35 @@ namespace ecs {
 	
 	struct world;
 
+	struct recycle_policy
+	{
+		enum class order_t { lifo, fifo };
+
+		// Order in which destroyed entity indices are handed out again.
+		order_t order{ order_t::fifo };
+
+		// A destroyed index is only reused once this many others are waiting behind it,
+		// so stale handles don't immediately alias a new entity in the same slot.
+		uint32_t minimum_free{ 1024 };
+
+		// Retire a slot instead of recycling it once its version would wrap around.
+		bool retire_on_version_wrap{ true };
+	};
+
+	// Hooks a world runs after a component is added to an entity and before it is
+	// removed, destroy_entity included. reset runs when the world drops every entity
+	// at once; rebuild() then replays on_add for every entity that has the component.
+	struct component_observer
+	{
+		using entity_hook = void(*)(void* context, ecs::world& world, entity_id entity);
+
+		int component_id{ -1 };
+		void* context{ nullptr };
+		entity_hook on_add{ nullptr };
+		entity_hook on_remove{ nullptr };
+		void(*reset)(void* context) { nullptr };
+	};
+
 	struct entity_builder
 	{
 		entity_builder(entity_id id, ecs::world* world)
@@ -34,40 +81,67 @@ namespace ecs {
 
 	struct world
 	{
-		world()
+		// All of the world's memory, including every component pool, comes from resource.
+		world(recycle_policy policy = {}, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			:entities(resource), handles(resource), policy(policy),
+			component_pools(resource), queries(resource), observers(resource), names(resource), indices(resource), resource(resource)
 		{
 			entities.reserve(MAX_ENTITIES);
+			handles.reserve(MAX_ENTITIES);
 		};
 
+		explicit world(std::pmr::memory_resource* resource)
+			:world(recycle_policy{}, resource)
+		{}
+
 		struct entity_desc
 		{
 			entity_id id{};
 			component_mask mask{};
 		};
 
+		// Maps the index part of an entity_id to its current slot in entities.
+		struct entity_handle
+		{
+			entity_index slot{ INVALID_ENTITY_INDEX };
+			entity_version version{ 0 };
+			// Links destroyed handles into the free list, unused while alive.
+			entity_index next_free{ INVALID_ENTITY_INDEX };
+		};
+
 		entity_builder create_entity()
 		{
-			if (!free_entities.empty())
-			{
-				const auto new_index = free_entities.back();
-				const auto new_version = get_entity_version(entities[new_index].id);
-				free_entities.pop_back();
+			const bool table_full = handles.size() >= MAX_ENTITIES;
+			entity_index handle{ INVALID_ENTITY_INDEX };
 
-				const auto new_id = create_entity_id(new_index, new_version);
-				entities[new_index].id = new_id;
-				return entity_builder(new_id, this);
+			// Once the table is full, ignore the minimum and recycle whatever is free.
+			if (free_count > 0 && (free_count > policy.minimum_free || table_full))
+			{
+				handle = pop_free_entity();
 			}
-
-			if (entities.size() >= MAX_ENTITIES) [[unlikely]]
+			else if (!table_full)
+			{
+				handle = static_cast<entity_index>(handles.size());
+				handles.emplace_back();
+			}
+			else [[unlikely]]
 			{
 				//std::cerr << "Reached max entities!\n";
 				return entity_builder(0, nullptr);
 			}
 
-			entity_desc new_entity;
-			new_entity.id = create_entity_id(static_cast<entity_index> (entities.size()), 0);
-			entities.emplace_back(new_entity);
-			return entity_builder(new_entity.id, this);
+			// Reuse the handle's previous slot if nobody was compacted into it.
+			auto slot = handles[handle].slot;
+			if (slot >= scan_end || is_entity_valid(entities[slot].id))
+			{
+				slot = acquire_slot();
+			}
+
+			const auto new_id = create_entity_id(handle, handles[handle].version);
+			handles[handle].slot = slot;
+			entities[slot].id = new_id;
+			entities[slot].mask.reset();
+			return entity_builder(new_id, this);
 		}
 
 
@@ -76,17 +150,17 @@ namespace ecs {
 		{
 			const auto component_id = detail::type_id<T>();
 
-			if (component_pools.size() <= component_id) [[unlikely]]
-			{
-				component_pools.reserve(component_id + 1);
-				component_pools.push_back(std::make_unique<pools>(pool_t<typename T::storage_type>(sizeof(T))));
-			}
+			create_pool<T>(component_id);
 
-			const auto entity_index = get_entity_index(entity);
-			const auto component = ::new(get_componenent_address<T> (entity_index, component_id)) T{};
+			const auto slot = get_entity_slot(entity);
+			notify_replaced(slot, component_id);
+			commit_slot<T>(slot, component_id);
+			::new(get_componenent_address<T> (slot, component_id)) T{};
 
-			entities[entity_index].mask.set(component_id);
-			return *component;
+			// Joining the owning group may move the entity to another slot.
+			set_mask(slot, component_mask(entities[slot].mask).set(component_id));
+			notify_added(component_id, entity);
+			return *get_componenent_address<T>(get_entity_slot(entity), component_id);
 		}
 
 		template<ECS_COMPONENT T, typename... Args>
@@ -94,28 +168,46 @@ namespace ecs {
 		{
 			const auto component_id = detail::type_id<T>();
 
-			if (component_pools.size() <= component_id) [[unlikely]]
-			{
-				component_pools.reserve(component_id + 1);
-				component_pools.push_back(std::make_unique<pools>(pool_t<typename T::storage_type>(sizeof(T))));
-			}
+			create_pool<T>(component_id);
 
-			const auto entity_index = get_entity_index(entity);
-			const auto component = ::new(get_componenent_address<T>(entity_index, component_id)) T(std::forward<Args>(args)...);
-			entities[entity_index].mask.set(component_id);
-			return *component;
+			const auto slot = get_entity_slot(entity);
+			notify_replaced(slot, component_id);
+			commit_slot<T>(slot, component_id);
+			::new(get_componenent_address<T>(slot, component_id)) T(std::forward<Args>(args)...);
+			set_mask(slot, component_mask(entities[slot].mask).set(component_id));
+			notify_added(component_id, entity);
+			return *get_componenent_address<T>(get_entity_slot(entity), component_id);
 		}
 
 		template<ECS_COMPONENT T>
 		T& get_component(entity_id entity)
 		{
 			const auto component_id = detail::type_id<T>();
-			const auto entity_index = get_entity_index(entity);
+			const auto slot = get_entity_slot(entity);
 
 
-			assert(entities[entity_index].mask.test(component_id) && "get component on entity without component!");
+			assert(entities[slot].mask.test(component_id) && "get component on entity without component!");
 
-			return *get_componenent_address<T>(entity_index, component_id);
+			return *get_componenent_address<T>(slot, component_id);
+		}
+
+		template<ECS_COMPONENT T>
+		T* try_get_component(entity_id entity)
+		{
+			return try_get_component_at<T>(get_entity_slot(entity));
+		}
+
+		// Component of whichever entity occupies slot, for callers that cache slots.
+		template<ECS_COMPONENT T>
+		T* try_get_component_at(entity_index slot)
+		{
+			const auto component_id = detail::type_id<T>();
+
+			if (!entities[slot].mask.test(component_id))
+			{
+				return nullptr;
+			}
+			return get_componenent_address<T>(slot, component_id);
 		}
 
 		template<ECS_COMPONENT... Ts>
@@ -127,26 +219,327 @@ namespace ecs {
 		template<ECS_COMPONENT T>
 		void remove_component(entity_id entity)
 		{
-			const auto entity_index = get_entity_index(entity);
+			const auto slot = get_entity_slot(entity);
 
-			if (entities[entity_index].id != entity) [[unlikely]]
+			if (entities[slot].id != entity) [[unlikely]]
 			{
 				std::cerr << "Remove component failed!\n";
 				return;
 			}
 
 			const auto component_id = detail::type_id<T>();
-			entities[entity_index].mask.reset(component_id);
+			notify_removed(component_mask().set(component_id) & entities[slot].mask, entity);
+			set_mask(slot, component_mask(entities[slot].mask).reset(component_id));
 		}
 
 		void destroy_entity(entity_id entity)
 		{
-			const auto new_id = create_entity_id(INVALID_ENTITY_INDEX, get_entity_version(entity) + 1);
-			const auto entity_index = get_entity_index(entity);
+			const auto handle = get_entity_index(entity);
+			auto slot = handles[handle].slot;
+
+			if (slot >= scan_end || entities[slot].id != entity) [[unlikely]]
+			{
+				std::cerr << "Destroy entity failed!\n";
+				return;
+			}
+
+			notify_removed(entities[slot].mask, entity);
+			set_mask(slot, {});
+			slot = handles[handle].slot;
+			entities[slot].id = INVALID_ENTITY;
+			compact_cursor = std::min(compact_cursor, slot);
+			trim_scan_end();
+
+			const auto version = get_entity_version(entity);
+			handles[handle].version = version + 1;
+
+			if (policy.retire_on_version_wrap && version == std::numeric_limits<entity_version>::max()) [[unlikely]]
+			{
+				return;
+			}
+
+			push_free_entity(handle);
+		}
+
+		entity_index get_entity_slot(entity_id entity) const
+		{
+			return handles[get_entity_index(entity)].slot;
+		}
+
+		// Moves live entities from the back of the table into holes left by destroyed
+		// ones, so views only scan [0, scan_end). Entity ids stay valid.
+		void compact()
+		{
+			compact(std::numeric_limits<uint32_t>::max());
+		}
+
+		// Incremental variant, relocates at most max_moves entities.
+		// Returns true once the table has no holes left.
+		bool compact(uint32_t max_moves)
+		{
+			for (;;)
+			{
+				while (compact_cursor < scan_end && is_entity_valid(entities[compact_cursor].id))
+				{
+					compact_cursor++;
+				}
+
+				if (compact_cursor >= scan_end)
+				{
+					return true;
+				}
+
+				if (max_moves == 0)
+				{
+					return false;
+				}
+
+				// trim_scan_end keeps the last slot below scan_end alive.
+				move_entity(scan_end - 1, compact_cursor);
+				trim_scan_end();
+				max_moves--;
+			}
+		}
+
+		// Moves the entities into consecutive slots right after the group, in order, so
+		// walking them walks their pools front to back. Grouped entities keep their slots
+		// and later structural changes or compaction may move any of them again.
+		void pack(std::span<const entity_id> order)
+		{
+			auto target = group_size;
+			for (const auto entity : order)
+			{
+				const auto slot = get_entity_slot(entity);
+				if (slot >= group_size && slot < scan_end && entities[slot].id == entity)
+				{
+					swap_entities(slot, target++);
+				}
+			}
+			trim_scan_end();
+		}
+
+		// Returns the cached query for the masks, building it on first use.
+		detail::cached_query& register_query(component_mask mask, component_mask excluded = {})
+		{
+			for (const auto& query : queries)
+			{
+				if (query->mask == mask && query->excluded == excluded)
+				{
+					return *query;
+				}
+			}
+
+			auto& query = *queries.emplace_back(detail::make_resource_ptr<detail::cached_query>(resource, mask, excluded, resource));
+			fill_query(query);
+			return query;
+		}
+
+		// Keeps every entity matching mask packed into slots [0, group_size), so the
+		// group's components are index aligned at the front of their pools.
+		// A world owns at most one group.
+		template<ECS_COMPONENT... Ts>
+		void register_group()
+		{
+			static_assert((!std::is_same_v<typename Ts::storage_type, small_storage_t> && ...), "Grouped components can't use small storage");
+
+			component_mask mask;
+			(mask.set(detail::type_id<Ts>()), ...);
+
+			if (group_mask == mask)
+			{
+				return;
+			}
+			assert(group_mask.none() && "World already owns a different group");
+
+			(create_pool<Ts>(detail::type_id<Ts>()), ...);
+			group_mask = mask;
+			fill_group();
+		}
+
+		// Memory committed by virtual storage pools, all other pools are fully committed.
+		size_t virtual_committed_bytes() const
+		{
+			size_t bytes = 0;
+			for (const auto& pool : component_pools)
+			{
+				if (pool)
+				{
+					if (const auto virtual_pool = std::get_if<pool_t<virtual_storage_t>>(pool.get()))
+					{
+						bytes += virtual_pool->committed_bytes();
+					}
+				}
+			}
+			return bytes;
+		}
+
+		// Calls observer's hooks for its component from now on. Entities that already
+		// have the component are passed to on_add.
+		void observe(const component_observer& observer)
+		{
+			observers.push_back(observer);
+			observed.set(observer.component_id);
+			replay_added(observer);
+		}
+
+		// Drops every observer registered with context.
+		void unobserve(const void* context)
+		{
+			std::erase_if(observers, [=](const component_observer& observer) { return observer.context == context; });
+
+			observed.reset();
+			for (const auto& observer : observers)
+			{
+				observed.set(observer.component_id);
+			}
+		}
+
+		// Indexes entities by the interned string in field of T for find_by_name. Kept up
+		// to date as T is added, removed or patched, assigning to field directly isn't tracked.
+		// Registering the same field again does nothing.
+		template<ECS_COMPONENT T, interned_string T::* field = &T::value>
+		void register_name_index()
+		{
+			const component_observer observer{ detail::type_id<T>(), &names,
+				[](void* context, ecs::world& world, entity_id entity)
+				{
+					static_cast<detail::entity_multimap*>(context)->insert((world.get_component<T>(entity).*field).handle.value, entity);
+				},
+				[](void* context, ecs::world& world, entity_id entity)
+				{
+					static_cast<detail::entity_multimap*>(context)->erase((world.get_component<T>(entity).*field).handle.value, entity);
+				},
+				[](void* context)
+				{
+					static_cast<detail::entity_multimap*>(context)->clear();
+				} };
 
-			entities[entity_index].id = new_id;
-			entities[entity_index].mask.reset();
-			free_entities.push_back(entity_index);
+			for (const auto& registered : observers)
+			{
+				if (registered.context == observer.context && registered.on_add == observer.on_add)
+				{
+					return;
+				}
+			}
+			observe(observer);
+		}
+
+		// Registers an index like hashed_index<T, &T::field> or ordered_index<T, &T::field>,
+		// or returns the one registered before.
+		template<typename Index>
+		Index& register_index()
+		{
+			using T = typename Index::component_type;
+
+			const auto tag = detail::type_tag<Index>();
+			for (const auto& index : indices)
+			{
+				if (index.tag == tag)
+				{
+					return *static_cast<Index*>(index.object.get());
+				}
+			}
+
+			auto object = std::allocate_shared<Index>(std::pmr::polymorphic_allocator<Index>(resource), resource);
+			indices.push_back({ tag, object });
+			observe({ detail::type_id<T>(), object.get(),
+				[](void* context, ecs::world& world, entity_id entity)
+				{
+					static_cast<Index*>(context)->insert(world.get_component<T>(entity).*Index::field, entity);
+				},
+				[](void* context, ecs::world& world, entity_id entity)
+				{
+					static_cast<Index*>(context)->erase(world.get_component<T>(entity).*Index::field, entity);
+				},
+				[](void* context)
+				{
+					static_cast<Index*>(context)->clear();
+				} });
+			return *object;
+		}
+
+		// Changes T in place through func and lets observers, like indices, see the change.
+		template<ECS_COMPONENT T, typename Func>
+		void patch(entity_id entity, Func&& func)
+		{
+			const auto component_id = detail::type_id<T>();
+			notify_removed(component_mask().set(component_id), entity);
+			func(get_component<T>(entity));
+			notify_added(component_id, entity);
+		}
+
+		// Returns one of the entities with the name, or INVALID_ENTITY when no entity has
+		// it or no name index is registered.
+		entity_id find_by_name(std::string_view name)
+		{
+			string_handle handle;
+			if (!global_strings().find(name, handle))
+			{
+				return INVALID_ENTITY;
+			}
+			return names.find(handle.value);
+		}
+
+		template<ECS_COMPONENT T>
+		auto& create_pool(int component_id)
+		{
+			if (component_pools.size() <= component_id) [[unlikely]]
+			{
+				component_pools.resize(component_id + 1);
+			}
+
+			if (!component_pools[component_id]) [[unlikely]]
+			{
+				component_pools[component_id] = detail::make_resource_ptr<pools>(resource, pool_t<typename T::storage_type>(detail::component_stride<T>(), detail::component_alignment<T>(), &detail::relocate_component<T>, resource));
+			}
+			return std::get<pool_t<typename T::storage_type>>(*component_pools[component_id]);
+		}
+
+		// Drops every entity and component pool. Registered queries and the group stay
+		// registered and are refilled by rebuild().
+		void clear()
+		{
+			entities.clear();
+			handles.clear();
+			component_pools.clear();
+			scan_end = 0;
+			compact_cursor = 0;
+			free_head = INVALID_ENTITY_INDEX;
+			free_tail = INVALID_ENTITY_INDEX;
+			free_count = 0;
+			group_size = 0;
+			for (const auto& query : queries)
+			{
+				query->entities.clear();
+				query->positions.clear();
+			}
+			reset_observers();
+		}
+
+		// Refills queries and the group after the entity table was written directly.
+		void rebuild()
+		{
+			for (const auto& query : queries)
+			{
+				query->entities.clear();
+				query->positions.clear();
+				fill_query(*query);
+			}
+
+			group_size = 0;
+			fill_group();
+
+			reset_observers();
+			for (const auto& observer : observers)
+			{
+				replay_added(observer);
+			}
+		}
+
+		template<ECS_COMPONENT T>
+		T* get_component_data()
+		{
+			return get_componenent_address<T>(0, detail::type_id<T>());
 		}
 
 		template<ECS_COMPONENT... Ts>
@@ -155,35 +548,383 @@ namespace ecs {
 			return view<Ts...>(this);
 		}
 
-		std::vector<entity_desc> entities;
-		std::vector<entity_index> free_entities;
+		std::pmr::vector<entity_desc> entities;
+		std::pmr::vector<entity_handle> handles;
+		recycle_policy policy;
+
+		// Every live entity has a slot below scan_end, views stop here.
+		entity_index scan_end{ 0 };
+		// No holes exist below this slot.
+		entity_index compact_cursor{ 0 };
+
+		// Intrusive free list threaded through handles[].next_free.
+		entity_index free_head{ INVALID_ENTITY_INDEX };
+		entity_index free_tail{ INVALID_ENTITY_INDEX };
+		uint32_t free_count{ 0 };
+
 		template <typename pool_tag>
 		using pool_t = detail::component_pool<pool_tag>;
 
-		using pools = std::variant<pool_t<default_storage_t>, pool_t<small_storage_t>>;
-		std::vector<std::unique_ptr<pools>> component_pools;
+		using pools = std::variant<pool_t<default_storage_t>, pool_t<small_storage_t>, pool_t<virtual_storage_t>>;
+		std::pmr::vector<detail::resource_ptr<pools>> component_pools;
+
+		std::pmr::vector<detail::resource_ptr<detail::cached_query>> queries;
+
+		component_mask group_mask;
+		entity_index group_size{ 0 };
+
+		std::pmr::vector<component_observer> observers;
+		component_mask observed;
+
+		// Interned string handle to the entities with that name, filled by register_name_index.
+		detail::entity_multimap names;
+
+		struct registered_index
+		{
+			const void* tag{ nullptr };
+			std::shared_ptr<void> object;
+		};
+		std::pmr::vector<registered_index> indices;
+
+		std::pmr::memory_resource* resource{ nullptr };
 
 	private:
+		void fill_query(detail::cached_query& query)
+		{
+			for (entity_index slot = 0; slot < scan_end; ++slot)
+			{
+				if (is_entity_valid(entities[slot].id) && query.matches(entities[slot].mask))
+				{
+					query.insert(entities[slot].id);
+				}
+			}
+		}
+
+		void fill_group()
+		{
+			if (group_mask.none())
+			{
+				return;
+			}
+
+			for (entity_index slot = group_size; slot < scan_end; ++slot)
+			{
+				if (is_entity_valid(entities[slot].id) && group_mask == (group_mask & entities[slot].mask))
+				{
+					swap_entities(slot, group_size++);
+				}
+			}
+			trim_scan_end();
+		}
+
+		void notify_added(int component_id, entity_id entity)
+		{
+			if (!observed.test(component_id)) [[likely]]
+			{
+				return;
+			}
+
+			for (const auto& observer : observers)
+			{
+				if (observer.component_id == component_id && observer.on_add)
+				{
+					observer.on_add(observer.context, *this, entity);
+				}
+			}
+		}
+
+		// Runs on_remove for every observed component in mask while they are still readable.
+		void notify_removed(const component_mask& mask, entity_id entity)
+		{
+			if ((observed & mask).none()) [[likely]]
+			{
+				return;
+			}
+
+			for (const auto& observer : observers)
+			{
+				if (mask.test(observer.component_id) && observer.on_remove)
+				{
+					observer.on_remove(observer.context, *this, entity);
+				}
+			}
+		}
+
+		// Adding a component the entity already has replaces it.
+		void notify_replaced(entity_index slot, int component_id)
+		{
+			if (entities[slot].mask.test(component_id))
+			{
+				notify_removed(component_mask().set(component_id), entities[slot].id);
+			}
+		}
+
+		void replay_added(const component_observer& observer)
+		{
+			if (!observer.on_add)
+			{
+				return;
+			}
+
+			for (entity_index slot = 0; slot < scan_end; ++slot)
+			{
+				if (is_entity_valid(entities[slot].id) && entities[slot].mask.test(observer.component_id))
+				{
+					observer.on_add(observer.context, *this, entities[slot].id);
+				}
+			}
+		}
+
+		void reset_observers()
+		{
+			for (const auto& observer : observers)
+			{
+				if (observer.reset)
+				{
+					observer.reset(observer.context);
+				}
+			}
+		}
+
 		template<ECS_COMPONENT T>
-		inline T* get_componenent_address(entity_index entity_index, int component_id)
+		void commit_slot(entity_index slot, int component_id)
 		{
-			return static_cast<T*>(std::get<pool_t<typename T::storage_type>>(*component_pools[component_id]).get(entity_index));
+			if constexpr (std::is_same_v<typename T::storage_type, virtual_storage_t>)
+			{
+				std::get<pool_t<virtual_storage_t>>(*component_pools[component_id]).commit(slot);
+			}
+		}
+
+		void set_mask(entity_index slot, component_mask mask)
+		{
+			for (const auto& query : queries)
+			{
+				query->update(entities[slot].id, entities[slot].mask, mask);
+			}
+			entities[slot].mask = mask;
+
+			if (group_mask.none())
+			{
+				return;
+			}
+
+			const bool was_grouped = slot < group_size;
+			const bool grouped = group_mask == (group_mask & mask);
+			if (grouped && !was_grouped)
+			{
+				// Slot group_size may be a hole, which then ends up at the old slot.
+				swap_entities(slot, group_size++);
+				trim_scan_end();
+			}
+			else if (!grouped && was_grouped)
+			{
+				swap_entities(slot, --group_size);
+			}
+		}
+
+		void swap_entities(entity_index a, entity_index b)
+		{
+			if (a == b)
+			{
+				return;
+			}
+
+			const auto mask_a = entities[a].mask;
+			const auto mask_b = entities[b].mask;
+			for (size_t component_id = 0; component_id < component_pools.size(); ++component_id)
+			{
+				const bool in_a = mask_a.test(component_id);
+				const bool in_b = mask_b.test(component_id);
+				if (!in_a && !in_b)
+				{
+					continue;
+				}
+
+				std::visit([=](auto& pool)
+					{
+						if (in_a && in_b)
+						{
+							pool.swap(a, b);
+						}
+						else if (in_a)
+						{
+							pool.move(a, b);
+						}
+						else
+						{
+							pool.move(b, a);
+						}
+					}, *component_pools[component_id]);
+			}
+
+			std::swap(entities[a], entities[b]);
+			for (const auto slot : { a, b })
+			{
+				if (is_entity_valid(entities[slot].id))
+				{
+					handles[get_entity_index(entities[slot].id)].slot = slot;
+				}
+			}
+		}
+
+		entity_index acquire_slot()
+		{
+			if (scan_end >= MAX_ENTITIES) [[unlikely]]
+			{
+				compact();
+			}
+
+			const auto slot = scan_end++;
+			if (slot == entities.size())
+			{
+				entities.emplace_back();
+			}
+			return slot;
+		}
+
+		void trim_scan_end()
+		{
+			while (scan_end > 0 && !is_entity_valid(entities[scan_end - 1].id))
+			{
+				scan_end--;
+			}
+			compact_cursor = std::min(compact_cursor, scan_end);
+		}
+
+		void move_entity(entity_index from, entity_index to)
+		{
+			const auto& mask = entities[from].mask;
+			for (size_t component_id = 0; component_id < component_pools.size(); ++component_id)
+			{
+				if (mask.test(component_id))
+				{
+					std::visit([=](auto& pool) { pool.move(from, to); }, *component_pools[component_id]);
+				}
+			}
+
+			entities[to] = entities[from];
+			entities[from] = entity_desc{ INVALID_ENTITY, {} };
+			handles[get_entity_index(entities[to].id)].slot = to;
+		}
+
+		void push_free_entity(entity_index handle)
+		{
+			handles[handle].next_free = INVALID_ENTITY_INDEX;
+
+			if (free_count == 0)
+			{
+				free_head = handle;
+				free_tail = handle;
+			}
+			else if (policy.order == recycle_policy::order_t::fifo)
+			{
+				handles[free_tail].next_free = handle;
+				free_tail = handle;
+			}
+			else
+			{
+				handles[handle].next_free = free_head;
+				free_head = handle;
+			}
+			free_count++;
+		}
+
+		entity_index pop_free_entity()
+		{
+			const auto handle = free_head;
+			free_head = handles[handle].next_free;
+			handles[handle].next_free = INVALID_ENTITY_INDEX;
+
+			if (--free_count == 0)
+			{
+				free_tail = INVALID_ENTITY_INDEX;
+			}
+			return handle;
+		}
+
+		template<ECS_COMPONENT T>
+		inline T* get_componenent_address(entity_index slot, int component_id)
+		{
+			return static_cast<T*>(std::get<pool_t<typename T::storage_type>>(*component_pools[component_id]).get(slot));
 		}
 	};
 
+	// View and query terms. A plain component is required and passed by reference,
+	// exclude<...> rejects entities having any of its components and optional<T>
+	// passes a T* that is null when the entity lacks T.
 	template<ECS_COMPONENT... Ts>
+	struct exclude {};
+
+	template<ECS_COMPONENT T>
+	struct optional {};
+
+	namespace detail {
+		template<typename Term>
+		struct term_traits
+		{
+			constexpr static bool required = true;
+
+			static void add_to(component_mask& required, component_mask&)
+			{
+				required.set(type_id<Term>());
+			}
+
+			static auto fetch(ecs::world& world, entity_id entity)
+			{
+				return std::tuple<Term&>(world.get_component<Term>(entity));
+			}
+		};
+
+		template<ECS_COMPONENT... Ts>
+		struct term_traits<exclude<Ts...>>
+		{
+			constexpr static bool required = false;
+
+			static void add_to(component_mask&, component_mask& excluded)
+			{
+				(excluded.set(type_id<Ts>()), ...);
+			}
+
+			static auto fetch(ecs::world&, entity_id)
+			{
+				return std::tuple<>();
+			}
+		};
+
+		template<ECS_COMPONENT T>
+		struct term_traits<optional<T>>
+		{
+			constexpr static bool required = false;
+
+			static void add_to(component_mask&, component_mask&)
+			{
+			}
+
+			static auto fetch(ecs::world& world, entity_id entity)
+			{
+				return std::tuple<T*>(world.try_get_component<T>(entity));
+			}
+		};
+
+		template<typename... Terms, typename Func>
+		void invoke_terms(ecs::world& world, entity_id entity, Func&& func)
+		{
+			std::apply(func, std::tuple_cat(term_traits<Terms>::fetch(world, entity)...));
+		}
+
+		template<typename... Terms, typename Func>
+		void invoke_terms_with_entity(ecs::world& world, entity_id entity, Func&& func)
+		{
+			std::apply(func, std::tuple_cat(std::tuple<entity_id>(entity), term_traits<Terms>::fetch(world, entity)...));
+		}
+	}
+
+	template<typename... Ts>
 	struct view
 	{
 		view(ecs::world& world) : world(&world)
 		{
-			if constexpr (sizeof...(Ts) > 0)
-			{
-				const int component_ids[] = { detail::type_id<Ts>() ... };
-				for (const auto& id : component_ids)
-				{
-					mask.set(id);
-				}
-			}
+			(detail::term_traits<Ts>::add_to(mask, excluded), ...);
 			// Todo logic on storage types. only check small storage list of entities if present!
 		}
 
@@ -192,7 +933,7 @@ namespace ecs {
 		{
 			for (const auto entity : *this)
 			{
-				func(world->get_component<Ts>(entity)...);
+				detail::invoke_terms<Ts...>(*world, entity, func);
 			}
 		};
 
@@ -201,20 +942,21 @@ namespace ecs {
 		{
 			for (const auto entity : *this)
 			{
-				func(entity, world->get_component<Ts>(entity)...);
+				detail::invoke_terms_with_entity<Ts...>(*world, entity, func);
 			}
 		};
 
 		ecs::world* world{ nullptr };
 		component_mask mask;
+		component_mask excluded;
 
 		// If 0 template arguments we want all entities
 		constexpr static bool all = (sizeof...(Ts) == 0);
 
 		struct iterator
 		{
-			iterator(ecs::world* world, entity_index index, component_mask mask) noexcept
-				: world(world), index(index), mask(mask) {}
+			iterator(ecs::world* world, entity_index index, component_mask mask, component_mask excluded) noexcept
+				: world(world), index(index), mask(mask), excluded(excluded) {}
 
 			auto operator*() const
 			{
@@ -223,12 +965,13 @@ namespace ecs {
 
 			bool operator==(const iterator& other) const
 			{
-				return index == other.index || index == world->entities.size();
+				return index == other.index || index >= world->scan_end;
 			}
 
 			bool operator!=(const iterator& other) const
 			{
-				return (index != other.index && index != world->entities.size());
+				// Destroying entities while iterating may pull scan_end below index.
+				return (index != other.index && index < world->scan_end);
 			}
 
 			iterator& operator++()
@@ -236,7 +979,7 @@ namespace ecs {
 				do
 				{
 					index++;
-				} while (index < world->entities.size() && !valid_index());
+				} while (index < world->scan_end && !valid_index());
 				return *this;
 			}
 
@@ -249,7 +992,7 @@ namespace ecs {
 				else
 				{
 					return is_entity_valid(world->entities[index].id) &&
-						(mask == (mask & world->entities[index].mask));
+						matches(world->entities[index].mask, mask, excluded);
 				}
 
 			}
@@ -258,26 +1001,143 @@ namespace ecs {
 			ecs::world* world{ };
 			entity_index index{ };
 			component_mask mask{ };
+			component_mask excluded{ };
 		};
 
 		const iterator begin() const
 		{
 			entity_index first_index = 0;
-			while (first_index < world->entities.size() &&
-				(mask != (mask & world->entities[first_index].mask)
+			while (first_index < world->scan_end &&
+				(!matches(world->entities[first_index].mask, mask, excluded)
 					|| !is_entity_valid(world->entities[first_index].id)))
 			{
 				first_index++;
 			}
-			return iterator(world, first_index, mask);
+			return iterator(world, first_index, mask, excluded);
 		}
 
 		const iterator end() const
 		{
-			return iterator(world, entity_index(world->entities.size()), mask);
+			return iterator(world, entity_index(world->scan_end), mask, excluded);
+		}
+
+	private:
+		static bool matches(const component_mask& entity_mask, const component_mask& mask, const component_mask& excluded)
+		{
+			return mask == (mask & entity_mask) && (excluded & entity_mask).none();
 		}
 	};
 
+	// Like view, but iterates a dense entity list the world keeps up to date
+	// instead of scanning the entity table.
+	template<typename... Ts>
+	struct query
+	{
+		static_assert((detail::term_traits<Ts>::required || ...), "Query needs at least one required component");
+
+		query(ecs::world& world) : world(&world)
+		{
+			component_mask mask;
+			component_mask excluded;
+			(detail::term_traits<Ts>::add_to(mask, excluded), ...);
+			state = &world.register_query(mask, excluded);
+		}
+
+		// Iterates back to front, so destroying the current entity is safe.
+		template<typename Func>
+		void for_each(Func&& func)
+		{
+			for (auto i = state->entities.size(); i-- > 0;)
+			{
+				detail::invoke_terms<Ts...>(*world, state->entities[i], func);
+			}
+		};
+
+		template<typename Func>
+		void for_each_entity(Func&& func)
+		{
+			for (auto i = state->entities.size(); i-- > 0;)
+			{
+				detail::invoke_terms_with_entity<Ts...>(*world, state->entities[i], func);
+			}
+		};
+
+		const std::pmr::vector<entity_id>& entities() const
+		{
+			return state->entities;
+		}
+
+		size_t size() const
+		{
+			return state->entities.size();
+		}
+
+		ecs::world* world{ nullptr };
+		detail::cached_query* state{ nullptr };
+	};
+
+	// Iterates the world's owning group as parallel component arrays.
+	template<ECS_COMPONENT... Ts>
+	struct group
+	{
+		group(ecs::world& world) : world(&world)
+		{
+			world.register_group<Ts...>();
+		}
+
+		// Iterates back to front, so destroying the current entity is safe.
+		template<typename Func>
+		void for_each(Func&& func)
+		{
+			iterate(func, world->get_component_data<Ts>()...);
+		}
+
+		template<typename Func>
+		void for_each_entity(Func&& func)
+		{
+			iterate_with_entity(func, world->get_component_data<Ts>()...);
+		}
+
+		size_t size() const
+		{
+			return world->group_size;
+		}
+
+		ecs::world* world{ nullptr };
+
+	private:
+		// Pools may pad components out to their alignment, so index with the pool stride.
+		template<typename T>
+		static T& at(T* data, size_t index)
+		{
+			if constexpr (detail::component_stride<T>() == sizeof(T))
+			{
+				return data[index];
+			}
+			else
+			{
+				return *reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(data) + index * detail::component_stride<T>());
+			}
+		}
+
+		template<typename Func, typename... Cs>
+		void iterate(Func& func, Cs*... data)
+		{
+			for (auto i = world->group_size; i-- > 0;)
+			{
+				func(at(data, i)...);
+			}
+		}
+
+		template<typename Func, typename... Cs>
+		void iterate_with_entity(Func& func, Cs*... data)
+		{
+			for (auto i = world->group_size; i-- > 0;)
+			{
+				func(world->entities[i].id, at(data, i)...);
+			}
+		}
+	};
 
 	template<ECS_COMPONENT T, typename... Args>
 	entity_builder& entity_builder::with(Args&&... args)
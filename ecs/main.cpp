@@ -39,6 +39,16 @@ void make_enemy(ecs::world& world, float x, float y)
 		.with<Enemy>();
 }
 
+void make_attachment(ecs::world& world, ecs::hierarchy& hierarchy, ecs::entity_id parent, vf2d offset, olc::Pixel color)
+{
+	const auto attachment = world.create_entity()
+		.with<Transform>(vf2d{ 0.0f, 0.0f })
+		.with<Attachment>(offset)
+		.with<Graphic>(color, vf2d{ 6, 6 }).id;
+
+	hierarchy.attach(attachment, parent);
+}
+
 class Example : public olc::PixelGameEngine
 {
 public:
@@ -50,7 +60,10 @@ public:
 public:
 	bool OnUserCreate() override
 	{
+		world.register_name_index<Name>();
 		player = make_player(world, "Frappe"s, olc::GREEN);
+		make_attachment(world, hierarchy, player, vf2d{ 12.0f, 0.0f }, olc::YELLOW);
+		make_attachment(world, hierarchy, player, vf2d{ -12.0f, 0.0f }, olc::CYAN);
 
 		for (int x = 0; x < 5; x++)
 		{
@@ -67,12 +80,18 @@ public:
 		Clear(olc::BLACK);
 
 		// Render System
-		ecs::view<Transform, Graphic>(world).for_each(
+		rect_positions.clear();
+		rect_sizes.clear();
+		rect_colors.clear();
+		ecs::query<Transform, Graphic>(world).for_each(
 			[&](const Transform& t, const Graphic& g)
 			{
-				FillRect(t.position - (0.5f * g.size), g.size, g.color);
+				rect_positions.push_back(t.position - (0.5f * g.size));
+				rect_sizes.push_back(g.size);
+				rect_colors.push_back(g.color);
 			}
 		);
+		FillRects(rect_positions, rect_sizes, rect_colors);
 
 		ecs::view<Transform, Player, CircleCollider>(world).for_each(
 			[&](const Transform& t, const Player& p, const CircleCollider& cc)
@@ -83,7 +102,7 @@ public:
 
 		// Enemy chase player system
 		auto player_pos = world.get_component<Transform>(player);
-		ecs::view<Transform, Enemy>(world).for_each(
+		ecs::group<Transform, Enemy>(world).for_each(
 			[&](Transform& t, const Enemy& e)
 			{
 				const auto path_to_player = (player_pos.position - t.position);
@@ -110,12 +129,21 @@ public:
 				t.position += movement * fElapsedTime * p.movement_speed;
 			}
 		);
+		hierarchy.mark_dirty(player);
+
+		// Attachment system, only walks subtrees whose root moved
+		hierarchy.propagate<Transform, Attachment>(
+			[](const Transform& parent, const Attachment& a, Transform& t)
+			{
+				t.position = parent.position + a.offset;
+			}
+		);
 
 		// Player collision system
 		ecs::view<Player, Transform, CircleCollider>(world).for_each(
 			[&](const auto& player, const auto& playerPos, const auto& playerCollider)
 			{
-				ecs::view<Enemy, Transform, CircleCollider>(world).for_each_entity(
+				ecs::query<Enemy, Transform, CircleCollider>(world).for_each_entity(
 					[=](const auto& enemy_id, const auto& enemy, const auto& enemyPos, const auto& enemyCollider)
 					{
 						const float distance = (enemyPos.position - playerPos.position).mag();
@@ -128,6 +156,9 @@ public:
 			}
 		);
 
+		// Fill holes left by destroyed enemies a few hundred entities at a time
+		world.compact(256);
+
 		// Spawn bunch of stuff on space
 		if (GetKey(olc::SPACE).bPressed)
 		{
@@ -159,12 +190,22 @@ public:
 
 private:
 	ecs::world world{};
+	ecs::hierarchy hierarchy{ world };
 	ecs::entity_id player{};
+	// Render batch, reused every frame
+	std::vector<olc::vi2d> rect_positions;
+	std::vector<olc::vi2d> rect_sizes;
+	std::vector<olc::Pixel> rect_colors;
 };
 
 int main()
 {
 	Example example;
+#if defined(OLC_PLATFORM_HEADLESS)
+	// Benchmark build, as many 60Hz steps as possible
+	olc::headless.nFrames = 1000;
+	olc::headless.fFixedElapsedTime = 1.0f / 60.0f;
+#endif
 	if (example.Construct(SCREEN_WIDTH, SCREEN_HEIGHT, 2, 2))
 	{
 		example.Start();
@@ -264,6 +264,8 @@ int main()
 #include <list>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <fstream>
 #include <map>
 #include <functional>
@@ -272,6 +274,7 @@ int main()
 #include <cstring>
 #include <cassert>
 #include <bit>
+#include <span>
 
 // O------------------------------------------------------------------------------O
 // | COMPILER CONFIGURATION ODDITIES                                              |
@@ -318,7 +321,7 @@ namespace _gfs = std::filesystem;
 // O------------------------------------------------------------------------------O
 
 // Platform
-#if !defined(OLC_PLATFORM_WINAPI) && !defined(OLC_PLATFORM_X11) && !defined(OLC_PLATFORM_GLUT)
+#if !defined(OLC_PLATFORM_WINAPI) && !defined(OLC_PLATFORM_X11) && !defined(OLC_PLATFORM_GLUT) && !defined(OLC_PLATFORM_HEADLESS)
 #if defined(_WIN32)
 #define OLC_PLATFORM_WINAPI
 #endif
@@ -330,8 +333,10 @@ namespace _gfs = std::filesystem;
 #endif
 #endif
 
-// Renderer
-#if !defined(OLC_GFX_OPENGL10) || !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10)
+// Renderer, the headless platform has nothing to present to
+#if defined(OLC_PLATFORM_HEADLESS)
+#define OLC_GFX_NULL
+#elif !defined(OLC_GFX_OPENGL10) || !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10)
 #define OLC_GFX_OPENGL10
 #endif
 
@@ -345,6 +350,16 @@ namespace _gfs = std::filesystem;
 #endif
 #endif
 
+// SIMD, define OLC_SIMD_NONE to force scalar pixel fills
+#if !defined(OLC_SIMD_NONE)
+#if defined(__AVX2__)
+#define OLC_SIMD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OLC_SIMD_SSE2
+#endif
+#endif
+
 
 // O------------------------------------------------------------------------------O
 // | PLATFORM-SPECIFIC DEPENDENCIES                                               |
@@ -384,6 +399,10 @@ namespace X11
 }
 #endif
 
+#if defined(OLC_SIMD_SSE2) || defined(OLC_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
 #if defined(OLC_PLATFORM_GLUT)
 #define PGE_USE_CUSTOM_START
 #if defined(__linux__)
@@ -408,6 +427,7 @@ namespace olc
 	constexpr uint8_t  nMouseButtons = 5;
 	constexpr uint8_t  nDefaultAlpha = 0xFF;
 	constexpr uint32_t nDefaultPixel = (nDefaultAlpha << 24);
+	constexpr int32_t  nDrawTileSize = 64;
 	enum rcode { FAIL = 0, OK = 1, NO_FILE = -1 };
 
 	// O------------------------------------------------------------------------------O
@@ -421,7 +441,7 @@ namespace olc
 			struct { uint8_t r; uint8_t g; uint8_t b; uint8_t a; };
 		};
 
-		enum Mode { NORMAL, MASK, ALPHA, CUSTOM };
+		enum Mode { NORMAL, MASK, ALPHA, CUSTOM, PREMULTIPLIED };
 
 		Pixel();
 		Pixel(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha = nDefaultAlpha);
@@ -442,6 +462,16 @@ namespace olc
 
 	Pixel PixelF(float red, float green, float blue, float alpha = 1.0f);
 	Pixel PixelLerp(const olc::Pixel& p1, const olc::Pixel& p2, float t);
+	// Sets count pixels from dst onwards to p, using SSE2/AVX2 stores when available
+	void FillPixels(olc::Pixel* dst, size_t count, olc::Pixel p);
+	// Blends p over count pixels from dst onwards with its alpha scaled by fBlend, in fixed
+	// point and SSE2/AVX2 when available. Straight alpha leaves the pixels opaque, for
+	// premultiplied alpha p's colour must already be scaled by its alpha
+	void BlendPixels(olc::Pixel* dst, size_t count, olc::Pixel p, float fBlend = 1.0f, bool bPremultiplied = false);
+	// As above with a colour per pixel taken from src, matching Draw in the alpha modes
+	void BlendPixels(olc::Pixel* dst, const olc::Pixel* src, size_t count, float fBlend = 1.0f, bool bPremultiplied = false);
+	// Copies the pixels of src with full alpha over dst, like Draw in MASK mode
+	void MaskPixels(olc::Pixel* dst, const olc::Pixel* src, size_t count);
 
 
 	// O------------------------------------------------------------------------------O
@@ -632,8 +662,16 @@ namespace olc
 		Pixel* GetData();
 		olc::Sprite* Duplicate();
 		olc::Sprite* Duplicate(const olc::vi2d& vPos, const olc::vi2d& vSize);
+		// Changes since the last texture upload are tracked in tiles of nDrawTileSize.
+		// SetPixel marks what it writes, writes through GetData() must call MarkDirty
+		void MarkDirty();
+		void MarkDirty(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+		void ClearDirty();
 		Pixel* pColData = nullptr;
 		Mode modeSample = Mode::NORMAL;
+		bool bDirtyAll = true;
+		int32_t nDirtyTilesX = 0;
+		std::vector<uint8_t> vDirtyTiles;
 
 		static std::unique_ptr<olc::ImageLoader> loader;
 	};
@@ -703,6 +741,17 @@ namespace olc
 		olc::Decal* decal = nullptr;
 	};
 
+	// Decal batching over the last frame, a state change is a texture or DecalMode
+	// switch between two draw calls. Saved counts compare against submission order
+	struct DecalBatchStats
+	{
+		uint32_t nDecals = 0;
+		uint32_t nDrawCalls = 0;
+		uint32_t nStateChanges = 0;
+		int32_t nDrawCallsSaved = 0;
+		int32_t nStateChangesSaved = 0;
+	};
+
 	struct LayerDesc
 	{
 		olc::vf2d vOffset = { 0, 0 };
@@ -728,8 +777,12 @@ namespace olc
 		virtual void	   SetDecalMode(const olc::DecalMode& mode) = 0;
 		virtual void       DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) = 0;
 		virtual void       DrawDecalQuad(const olc::DecalInstance& decal) = 0;
+		// Draws decals in order, renderers override this to batch them
+		virtual void       DrawDecals(std::span<const olc::DecalInstance> decals) { for (const auto& decal : decals) DrawDecalQuad(decal); }
 		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height, const bool filtered = false) = 0;
 		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) = 0;
+		// Uploads part of spr into a texture of the same size, renderers without sub-image updates upload all of it
+		virtual void       UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) { UNUSED(pos); UNUSED(size); UpdateTexture(id, spr); }
 		virtual uint32_t   DeleteTexture(const uint32_t id) = 0;
 		virtual void       ApplyTexture(uint32_t id) = 0;
 		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) = 0;
@@ -759,6 +812,23 @@ namespace olc
 	static std::unique_ptr<Platform> platform;
 	static std::map<size_t, uint8_t> mapKeys;
 
+	// Settings for OLC_PLATFORM_HEADLESS, which runs the engine without a window or GPU
+	struct HeadlessConfig
+	{
+		// Frames to run before shutting down, 0 runs until OnUserUpdate returns false
+		uint32_t nFrames = 0;
+		// Paces frames to this rate in real time, 0 runs them as fast as possible
+		float fFrameRate = 0.0f;
+		// Reported to OnUserUpdate instead of the measured time when above 0, for repeatable runs
+		float fFixedElapsedTime = 0.0f;
+		// Every nDumpEvery'th frame layer 0 is saved as sDumpPath<frame>.spr, 0 saves none
+		uint32_t nDumpEvery = 0;
+		std::string sDumpPath = "frame_";
+		// Called before each frame to feed input through the olc_Update... functions
+		std::function<void(olc::PixelGameEngine& pge, uint32_t nFrame)> funcInput = nullptr;
+	};
+	inline HeadlessConfig headless;
+
 	// O------------------------------------------------------------------------------O
 	// | olc::PixelGameEngine - The main BASE class for your application              |
 	// O------------------------------------------------------------------------------O
@@ -816,6 +886,8 @@ namespace olc
 		void SetDrawTarget(Sprite* target);
 		// Gets the current Frames Per Second
 		uint32_t GetFPS() const;
+		// Gets how decals were batched in the last frame
+		const olc::DecalBatchStats& GetDecalBatchStats() const;
 		// Gets last update of elapsed time
 		float GetElapsedTime() const;
 		// Gets Actual Window size
@@ -843,12 +915,22 @@ namespace olc
 		// olc::Pixel::NORMAL = No transparency
 		// olc::Pixel::MASK   = Transparent if alpha is < 255
 		// olc::Pixel::ALPHA  = Full transparency
+		// olc::Pixel::PREMULTIPLIED = Full transparency, colours already scaled by alpha
 		void SetPixelMode(Pixel::Mode m);
 		Pixel::Mode GetPixelMode();
 		// Use a custom blend function
 		void SetPixelMode(std::function<olc::Pixel(const int x, const int y, const olc::Pixel& pSource, const olc::Pixel& pDest)> pixelMode);
 		// Change the blend factor form between 0.0f to 1.0f;
 		void SetPixelBlend(float fBlend);
+		// Tiled rendering records Clear, FillRect, FillCircle and other span fills in
+		// any but CUSTOM mode into a command list instead of drawing them. The list is binned
+		// into nDrawTileSize tiles and rasterized by nWorkers threads plus the calling
+		// one, each owning whole tiles, when the frame ends, the draw target changes
+		// or anything else draws. nWorkers = 0 picks one per hardware thread
+		void SetTiledRendering(bool bEnable, uint32_t nWorkers = 0);
+		bool IsTiledRendering() const;
+		// Rasterizes recorded commands now, call before reading the draw target back
+		void FlushTiles();
 
 
 
@@ -871,6 +953,11 @@ namespace olc
 		// Fills a rectangle at (x,y) to (x+w,y+h)
 		void FillRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p = olc::WHITE);
 		void FillRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p = olc::WHITE);
+		// Batched fills, element i of every span describes one shape. Shapes are binned
+		// into screen tiles and each tile is filled in one cache resident pass, shapes
+		// still overlap in submission order
+		void FillRects(std::span<const olc::vi2d> pos, std::span<const olc::vi2d> size, std::span<const olc::Pixel> col);
+		void FillCircles(std::span<const olc::vi2d> pos, std::span<const int32_t> radius, std::span<const olc::Pixel> col);
 		// Draws a triangle between points (x1,y1), (x2,y2) and (x3,y3)
 		void DrawTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p = olc::WHITE);
 		void DrawTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p = olc::WHITE);
@@ -932,6 +1019,55 @@ namespace olc
 		std::string sAppName;
 
 	private: // Inner mysterious workings
+		// Fills pixels x1 to x2 inclusive on row y, clipped to the draw target
+		void FillSpan(int32_t x1, int32_t x2, int32_t y, Pixel p);
+		// Draws the w x h block at (ox,oy) of sprite row by row, clipped to the draw target
+		// first. The block must lie inside sprite and the pixel mode can't be CUSTOM
+		void BlitSprite(int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, int32_t scale, uint8_t flip);
+		// Source row of a flipped or scaled blit, laid out like the destination row
+		std::vector<Pixel> vBlitRow;
+
+		// A recorded fill clipped to [x1,x2) x [y1,y2) of the draw target. Rectangles have
+		// nSpans -1, circles are centred on (cx,cy) with half widths at vCircleSpans[nSpans]
+		struct TileCommand { int32_t x1, y1, x2, y2; int32_t cx, cy; int32_t nSpans; Pixel p; Pixel::Mode mode; float fBlend; };
+		// Custom pixel modes can't be recorded
+		void RecordRect(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, Pixel::Mode mode);
+		void RecordCircle(int32_t x, int32_t y, int32_t radius, Pixel p, Pixel::Mode mode);
+		// Lists the commands touching tile t in vTileItems[vTileStart[t]..vTileStart[t+1])
+		void BinCommands();
+		void RasterizeTile(uint32_t t);
+		void RasterizeTiles();
+		void TileWorker();
+		// Half widths of the rows of a filled circle, -1 where FillCircle skips a row
+		uint32_t CircleSpans(int32_t radius);
+		std::vector<TileCommand> vTileCommands;
+		std::vector<uint32_t> vTileStart;
+		std::vector<uint32_t> vTileCursor;
+		std::vector<uint32_t> vTileItems;
+		std::vector<int32_t> vCircleSpans;
+		std::vector<uint32_t> vCircleSpanStart;
+		bool bTiledRendering = false;
+		std::vector<std::thread> vTileWorkers;
+		std::mutex muxTiles;
+		std::condition_variable cvTileWork;
+		std::condition_variable cvTileDone;
+		uint64_t nTileJob = 0;
+		uint32_t nTileWorkersBusy = 0;
+		bool bTileWorkersQuit = false;
+		std::atomic<uint32_t> nNextTile = 0;
+
+		// Reorders decals so those sharing a texture and mode are adjacent. A decal only
+		// moves ahead of decals its bounds don't overlap, so the picture is unchanged
+		void BatchDecals(std::vector<DecalInstance>& vDecals);
+		// Uploads the parts of spr changed since its last upload
+		void UploadDirtyTiles(uint32_t nResID, olc::Sprite* spr);
+		struct DecalBatch { olc::Decal* decal; olc::DecalMode mode; float x1, y1, x2, y2; };
+		std::vector<DecalBatch> vDecalBatches;
+		std::vector<uint32_t> vDecalBatchOf;
+		std::vector<uint32_t> vDecalBatchStart;
+		std::vector<DecalInstance> vDecalScratch;
+		olc::DecalBatchStats sDecalStats;
+
 		Sprite* pDrawTarget = nullptr;
 		Pixel::Mode	nPixelMode = Pixel::NORMAL;
 		float		fBlendFactor = 1.0f;
@@ -1170,6 +1306,157 @@ namespace olc
 		return (p1 * t) + p2 * (1.0f - t);
 	}
 
+	void FillPixels(olc::Pixel* dst, size_t count, olc::Pixel p)
+	{
+#if defined(OLC_SIMD_AVX2)
+		// Scalar until dst is aligned, then eight pixels per store
+		for (; count > 0 && (reinterpret_cast<uintptr_t>(dst) & 31); count--) *dst++ = p;
+		const __m256i wide = _mm256_set1_epi32(int32_t(p.n));
+		for (; count >= 8; count -= 8, dst += 8)
+			_mm256_store_si256(reinterpret_cast<__m256i*>(dst), wide);
+#endif
+#if defined(OLC_SIMD_SSE2)
+		for (; count > 0 && (reinterpret_cast<uintptr_t>(dst) & 15); count--) *dst++ = p;
+		const __m128i quad = _mm_set1_epi32(int32_t(p.n));
+		for (; count >= 4; count -= 4, dst += 4)
+			_mm_store_si128(reinterpret_cast<__m128i*>(dst), quad);
+#endif
+		for (; count > 0; count--) *dst++ = p;
+	}
+
+	void BlendPixels(olc::Pixel* dst, size_t count, olc::Pixel p, float fBlend, bool bPremultiplied)
+	{
+		// Each channel becomes (d * nInv + nTerm[c] + 128) / 255 with the division done
+		// as (t + (t >> 8)) >> 8, exact for every value a blend can produce. Premultiplied
+		// colours are clamped to their alpha so no channel can overflow 16 bits
+		const uint32_t nAlpha = uint32_t(float(p.a) * fBlend + 0.5f);
+		const uint32_t nInv = 255 - nAlpha;
+		uint16_t nTerm[4];
+		for (int c = 0; c < 4; c++)
+		{
+			const uint32_t nChannel = (p.n >> (8 * c)) & 0xFF;
+			if (bPremultiplied)
+				nTerm[c] = uint16_t(std::min(uint32_t(float(nChannel) * fBlend + 0.5f), nAlpha) * 255);
+			else
+				nTerm[c] = uint16_t(c < 3 ? nChannel * nAlpha : 0);
+		}
+		const uint32_t nOpaque = bPremultiplied ? 0 : 0xFF000000;
+
+#if defined(OLC_SIMD_AVX2)
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i inv = _mm256_set1_epi16(int16_t(nInv));
+			const __m256i term = _mm256_set1_epi64x(int64_t(uint64_t(nTerm[0]) | uint64_t(nTerm[1]) << 16 | uint64_t(nTerm[2]) << 32 | uint64_t(nTerm[3]) << 48));
+			const __m256i half = _mm256_set1_epi16(128);
+			const __m256i opaque = _mm256_set1_epi32(int32_t(nOpaque));
+			auto blend = [&](__m256i d)
+			{
+				d = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, inv), term), half);
+				return _mm256_srli_epi16(_mm256_add_epi16(d, _mm256_srli_epi16(d, 8)), 8);
+			};
+			for (; count >= 8; count -= 8, dst += 8)
+			{
+				const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+				const __m256i lo = blend(_mm256_unpacklo_epi8(d, zero));
+				const __m256i hi = blend(_mm256_unpackhi_epi8(d, zero));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+			}
+		}
+#endif
+#if defined(OLC_SIMD_SSE2)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i inv = _mm_set1_epi16(int16_t(nInv));
+			const __m128i term = _mm_set1_epi64x(int64_t(uint64_t(nTerm[0]) | uint64_t(nTerm[1]) << 16 | uint64_t(nTerm[2]) << 32 | uint64_t(nTerm[3]) << 48));
+			const __m128i half = _mm_set1_epi16(128);
+			const __m128i opaque = _mm_set1_epi32(int32_t(nOpaque));
+			auto blend = [&](__m128i d)
+			{
+				d = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(d, inv), term), half);
+				return _mm_srli_epi16(_mm_add_epi16(d, _mm_srli_epi16(d, 8)), 8);
+			};
+			for (; count >= 4; count -= 4, dst += 4)
+			{
+				const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+				const __m128i lo = blend(_mm_unpacklo_epi8(d, zero));
+				const __m128i hi = blend(_mm_unpackhi_epi8(d, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+			}
+		}
+#endif
+		// Red and blue, then green and alpha, blend as two 16 bit lanes of one word
+		const uint32_t nTermRB = nTerm[0] | uint32_t(nTerm[2]) << 16;
+		const uint32_t nTermGA = nTerm[1] | uint32_t(nTerm[3]) << 16;
+		for (; count > 0; count--, dst++)
+		{
+			const uint32_t rb = (dst->n & 0x00FF00FF) * nInv + nTermRB + 0x00800080;
+			const uint32_t ga = ((dst->n >> 8) & 0x00FF00FF) * nInv + nTermGA + 0x00800080;
+			dst->n = (((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF) | ((ga + ((ga >> 8) & 0x00FF00FF)) & 0xFF00FF00) | nOpaque;
+		}
+	}
+
+	void BlendPixels(olc::Pixel* dst, const olc::Pixel* src, size_t count, float fBlend, bool bPremultiplied)
+	{
+		// Same arithmetic as the single colour version, with every scaled channel value
+		// it could need looked up instead of converted per pixel
+		uint32_t nScaled[256];
+		for (uint32_t v = 0; v < 256; v++) nScaled[v] = uint32_t(float(v) * fBlend + 0.5f);
+
+		for (; count > 0; count--, dst++, src++)
+		{
+			const uint32_t nAlpha = nScaled[src->a];
+			const uint32_t nInv = 255 - nAlpha;
+			uint32_t nTermRB, nTermGA, nOpaque;
+			if (bPremultiplied)
+			{
+				nTermRB = std::min(nScaled[src->r], nAlpha) * 255 | (std::min(nScaled[src->b], nAlpha) * 255) << 16;
+				nTermGA = std::min(nScaled[src->g], nAlpha) * 255 | (nAlpha * 255) << 16;
+				nOpaque = 0;
+			}
+			else
+			{
+				if (nAlpha == 0) { dst->n |= 0xFF000000; continue; }
+				if (nAlpha == 255) { dst->n = src->n | 0xFF000000; continue; }
+				nTermRB = (src->n & 0x00FF00FF) * nAlpha;
+				nTermGA = uint32_t(src->g) * nAlpha;
+				nOpaque = 0xFF000000;
+			}
+
+			const uint32_t rb = (dst->n & 0x00FF00FF) * nInv + nTermRB + 0x00800080;
+			const uint32_t ga = ((dst->n >> 8) & 0x00FF00FF) * nInv + nTermGA + 0x00800080;
+			dst->n = (((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF) | ((ga + ((ga >> 8) & 0x00FF00FF)) & 0xFF00FF00) | nOpaque;
+		}
+	}
+
+	void MaskPixels(olc::Pixel* dst, const olc::Pixel* src, size_t count)
+	{
+#if defined(OLC_SIMD_AVX2)
+		{
+			const __m256i alpha = _mm256_set1_epi32(int32_t(0xFF000000));
+			for (; count >= 8; count -= 8, dst += 8, src += 8)
+			{
+				const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+				const __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha), alpha);
+				_mm256_maskstore_epi32(reinterpret_cast<int*>(dst), mask, s);
+			}
+		}
+#endif
+#if defined(OLC_SIMD_SSE2)
+		{
+			const __m128i alpha = _mm_set1_epi32(int32_t(0xFF000000));
+			for (; count >= 4; count -= 4, dst += 4, src += 4)
+			{
+				const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+				const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+				const __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), alpha);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(_mm_and_si128(mask, s), _mm_andnot_si128(mask, d)));
+			}
+		}
+#endif
+		for (; count > 0; count--, dst++, src++)
+			if (src->a == 255) *dst = *src;
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::Sprite IMPLEMENTATION                                                   |
 	// O------------------------------------------------------------------------------O
@@ -1201,6 +1488,7 @@ namespace olc
 	olc::rcode Sprite::LoadFromPGESprFile(const std::string& sImageFile, olc::ResourcePack* pack)
 	{
 		if (pColData) delete[] pColData;
+		MarkDirty();
 		auto ReadData = [&](std::istream& is)
 		{
 			is.read((char*)&width, sizeof(int32_t));
@@ -1286,6 +1574,7 @@ namespace olc
 		if (x >= 0 && x < width && y >= 0 && y < height)
 		{
 			pColData[y * width + x] = p;
+			if (!bDirtyAll) vDirtyTiles[size_t(y / nDrawTileSize) * nDirtyTilesX + x / nDrawTileSize] = 1;
 			return true;
 		}
 		else
@@ -1326,10 +1615,34 @@ namespace olc
 		return pColData;
 	}
 
+	void Sprite::MarkDirty()
+	{
+		bDirtyAll = true;
+	}
+
+	void Sprite::MarkDirty(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+	{
+		if (bDirtyAll) return;
+		x1 = std::max(x1, 0); y1 = std::max(y1, 0);
+		x2 = std::min(x2, width); y2 = std::min(y2, height);
+		if (x1 >= x2 || y1 >= y2) return;
+		const int32_t tx1 = x1 / nDrawTileSize, tx2 = (x2 - 1) / nDrawTileSize;
+		for (int32_t ty = y1 / nDrawTileSize; ty <= (y2 - 1) / nDrawTileSize; ty++)
+			std::fill_n(vDirtyTiles.begin() + size_t(ty) * nDirtyTilesX + tx1, tx2 - tx1 + 1, uint8_t(1));
+	}
+
+	void Sprite::ClearDirty()
+	{
+		nDirtyTilesX = (width + nDrawTileSize - 1) / nDrawTileSize;
+		vDirtyTiles.assign(size_t(nDirtyTilesX) * ((height + nDrawTileSize - 1) / nDrawTileSize), 0);
+		bDirtyAll = false;
+	}
+
 
 	olc::rcode Sprite::LoadFromFile(const std::string& sImageFile, olc::ResourcePack* pack)
 	{
 		UNUSED(pack);
+		MarkDirty();
 		return loader->LoadImageResource(this, sImageFile, pack);
 	}
 
@@ -1608,7 +1921,9 @@ namespace olc
 	}
 
 	PixelGameEngine::~PixelGameEngine()
-	{}
+	{
+		SetTiledRendering(false);
+	}
 
 
 	olc::rcode PixelGameEngine::Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h, bool full_screen, bool vsync, bool cohesion)
@@ -1632,6 +1947,7 @@ namespace olc
 
 	void PixelGameEngine::SetScreenSize(int w, int h)
 	{
+		FlushTiles();
 		vScreenSize = { w, h };
 		vInvScreenSize = { 1.0f / float(w), 1.0f / float(h) };
 		for (auto& layer : vLayers)
@@ -1675,6 +1991,7 @@ namespace olc
 
 	void PixelGameEngine::SetDrawTarget(Sprite* target)
 	{
+		FlushTiles();
 		if (target)
 		{
 			pDrawTarget = target;
@@ -1688,6 +2005,7 @@ namespace olc
 
 	void PixelGameEngine::SetDrawTarget(uint8_t layer)
 	{
+		FlushTiles();
 		if (layer < vLayers.size())
 		{
 			pDrawTarget = vLayers[layer].pDrawTarget;
@@ -1772,6 +2090,11 @@ namespace olc
 		return nLastFPS;
 	}
 
+	const olc::DecalBatchStats& PixelGameEngine::GetDecalBatchStats() const
+	{
+		return sDecalStats;
+	}
+
 	bool PixelGameEngine::IsFocused() const
 	{
 		return bHasInputFocus;
@@ -1852,38 +2175,65 @@ namespace olc
 	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
 	{
 		assert(pDrawTarget && "No draw target active");
+		if (!vTileCommands.empty()) FlushTiles();
 
 		if (nPixelMode == Pixel::NORMAL)
 		{
 			return pDrawTarget->SetPixel(x, y, p);
 		}
 
-		//if (nPixelMode == Pixel::MASK)
-		//{
-		//	if (p.a == 255)
-		//		return pDrawTarget->SetPixel(x, y, p);
-		//}
-
-		//if (nPixelMode == Pixel::ALPHA)
-		//{
-		//	Pixel d = pDrawTarget->GetPixel(x, y);
-		//	float a = (float)(p.a / 255.0f) * fBlendFactor;
-		//	float c = 1.0f - a;
-		//	float r = a * (float)p.r + c * (float)d.r;
-		//	float g = a * (float)p.g + c * (float)d.g;
-		//	float b = a * (float)p.b + c * (float)d.b;
-		//	return pDrawTarget->SetPixel(x, y, Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b/*, (uint8_t)(p.a * fBlendFactor)*/));
-		//}
-
-		//if (nPixelMode == Pixel::CUSTOM)
-		//{
-		//	return pDrawTarget->SetPixel(x, y, funcPixelMode(x, y, p, pDrawTarget->GetPixel(x, y)));
-		//}
+		if (nPixelMode == Pixel::MASK)
+		{
+			if (p.a == 255)
+				return pDrawTarget->SetPixel(x, y, p);
+		}
+
+		if (nPixelMode == Pixel::ALPHA || nPixelMode == Pixel::PREMULTIPLIED)
+		{
+			if (x < 0 || y < 0 || x >= pDrawTarget->width || y >= pDrawTarget->height) return false;
+			BlendPixels(pDrawTarget->GetData() + y * pDrawTarget->width + x, 1, p, fBlendFactor, nPixelMode == Pixel::PREMULTIPLIED);
+			pDrawTarget->MarkDirty(x, y, x + 1, y + 1);
+			return true;
+		}
+
+		if (nPixelMode == Pixel::CUSTOM)
+		{
+			return pDrawTarget->SetPixel(x, y, funcPixelMode(x, y, p, pDrawTarget->GetPixel(x, y)));
+		}
 
 		return false;
 	}
 
 
+	void PixelGameEngine::FillSpan(int32_t x1, int32_t x2, int32_t y, Pixel p)
+	{
+		// Custom modes need every pixel's position, so go through Draw
+		if (nPixelMode == Pixel::CUSTOM)
+		{
+			for (int32_t x = x1; x <= x2; x++) Draw(x, y, p);
+			return;
+		}
+
+		assert(pDrawTarget && "No draw target active");
+		if (y < 0 || y >= pDrawTarget->height) return;
+		if (x1 < 0) x1 = 0;
+		if (x2 >= pDrawTarget->width) x2 = pDrawTarget->width - 1;
+		if (x2 < x1) return;
+		if (bTiledRendering)
+		{
+			RecordRect(x1, y, x2 + 1, y + 1, p, nPixelMode);
+			return;
+		}
+
+		Pixel* dst = pDrawTarget->GetData() + y * pDrawTarget->width + x1;
+		if (nPixelMode == Pixel::NORMAL || (nPixelMode == Pixel::MASK && p.a == 255))
+			FillPixels(dst, size_t(x2 - x1 + 1), p);
+		else if (nPixelMode != Pixel::MASK)
+			BlendPixels(dst, size_t(x2 - x1 + 1), p, fBlendFactor, nPixelMode == Pixel::PREMULTIPLIED);
+		else return;
+		pDrawTarget->MarkDirty(x1, y, x2 + 1, y + 1);
+	}
+
 	void PixelGameEngine::DrawLine(const olc::vi2d& pos1, const olc::vi2d& pos2, Pixel p, uint32_t pattern)
 	{
 		DrawLine(pos1.x, pos1.y, pos2.x, pos2.y, p, pattern);
@@ -1896,6 +2246,14 @@ namespace olc
 
 		auto rol = [&](void) { pattern = (pattern << 1) | (pattern >> 31); return pattern & 1; };
 
+		// Solid horizontal lines are a single span
+		if (dy == 0 && pattern == 0xFFFFFFFF)
+		{
+			if (x2 < x1) std::swap(x1, x2);
+			FillSpan(x1, x2, y1, p);
+			return;
+		}
+
 		// straight lines idea by gurkanctn
 		if (dx == 0) // Line is vertical
 		{
@@ -2019,6 +2377,12 @@ namespace olc
 		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
 			return;
 
+		if (bTiledRendering && nPixelMode != Pixel::CUSTOM)
+		{
+			RecordCircle(x, y, radius, p, nPixelMode);
+			return;
+		}
+
 		if (radius > 0)
 		{
 			int x0 = 0;
@@ -2027,8 +2391,7 @@ namespace olc
 
 			auto drawline = [&](int sx, int ex, int y)
 			{
-				for (int x = sx; x <= ex; x++)
-					Draw(x, y, p);
+				FillSpan(sx, ex, y, p);
 			};
 
 			while (y0 >= x0)
@@ -2053,6 +2416,249 @@ namespace olc
 			Draw(x, y, p);
 	}
 
+	void PixelGameEngine::SetTiledRendering(bool bEnable, uint32_t nWorkers)
+	{
+		FlushTiles();
+		if (!vTileWorkers.empty())
+		{
+			{
+				std::lock_guard<std::mutex> lock(muxTiles);
+				bTileWorkersQuit = true;
+			}
+			cvTileWork.notify_all();
+			for (auto& t : vTileWorkers) t.join();
+			vTileWorkers.clear();
+			bTileWorkersQuit = false;
+		}
+
+		bTiledRendering = bEnable;
+		if (!bEnable) return;
+
+		// The calling thread rasterizes tiles too
+		if (nWorkers == 0) nWorkers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+		for (uint32_t i = 0; i < nWorkers; i++)
+			vTileWorkers.emplace_back(&PixelGameEngine::TileWorker, this);
+	}
+
+	bool PixelGameEngine::IsTiledRendering() const
+	{
+		return bTiledRendering;
+	}
+
+	void PixelGameEngine::FlushTiles()
+	{
+		if (vTileCommands.empty()) return;
+		BinCommands();
+
+		if (vTileWorkers.empty())
+		{
+			for (uint32_t t = 0; t + 1 < uint32_t(vTileStart.size()); t++) RasterizeTile(t);
+		}
+		else
+		{
+			nNextTile = 0;
+			{
+				std::lock_guard<std::mutex> lock(muxTiles);
+				nTileWorkersBusy = uint32_t(vTileWorkers.size());
+				nTileJob++;
+			}
+			cvTileWork.notify_all();
+			RasterizeTiles();
+
+			std::unique_lock<std::mutex> lock(muxTiles);
+			cvTileDone.wait(lock, [&] { return nTileWorkersBusy == 0; });
+		}
+
+		vTileCommands.clear();
+	}
+
+	void PixelGameEngine::TileWorker()
+	{
+		uint64_t nSeenJob = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(muxTiles);
+				cvTileWork.wait(lock, [&] { return bTileWorkersQuit || nTileJob != nSeenJob; });
+				if (bTileWorkersQuit) return;
+				nSeenJob = nTileJob;
+			}
+
+			RasterizeTiles();
+
+			std::lock_guard<std::mutex> lock(muxTiles);
+			if (--nTileWorkersBusy == 0) cvTileDone.notify_one();
+		}
+	}
+
+	void PixelGameEngine::RasterizeTiles()
+	{
+		// Whole tiles are handed out one at a time, so no two threads touch the same pixels
+		const uint32_t nTiles = uint32_t(vTileStart.size()) - 1;
+		for (uint32_t t = nNextTile++; t < nTiles; t = nNextTile++)
+			RasterizeTile(t);
+	}
+
+	void PixelGameEngine::RecordRect(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, Pixel::Mode mode)
+	{
+		if (mode == Pixel::MASK)
+		{
+			if (p.a != 255) return;
+			mode = Pixel::NORMAL;
+		}
+
+		const int32_t w = GetDrawTargetWidth();
+		const int32_t h = GetDrawTargetHeight();
+		vTileCommands.push_back({ std::clamp(x1, 0, w), std::clamp(y1, 0, h), std::clamp(x2, 0, w), std::clamp(y2, 0, h), 0, 0, -1, p, mode, fBlendFactor });
+	}
+
+	void PixelGameEngine::RecordCircle(int32_t x, int32_t y, int32_t radius, Pixel p, Pixel::Mode mode)
+	{
+		if (mode == Pixel::MASK)
+		{
+			if (p.a != 255) return;
+			mode = Pixel::NORMAL;
+		}
+
+		if (radius < 0) return;
+		const int32_t w = GetDrawTargetWidth();
+		const int32_t h = GetDrawTargetHeight();
+		TileCommand c = { std::clamp(x - radius, 0, w), std::clamp(y - radius, 0, h), std::clamp(x + radius + 1, 0, w), std::clamp(y + radius + 1, 0, h), x, y, -1, p, mode, fBlendFactor };
+		if (c.x1 >= c.x2 || c.y1 >= c.y2) return;
+		c.nSpans = int32_t(CircleSpans(radius));
+		vTileCommands.push_back(c);
+	}
+
+	void PixelGameEngine::BinCommands()
+	{
+		const int32_t nTilesX = (pDrawTarget->width + nDrawTileSize - 1) / nDrawTileSize;
+		const int32_t nTilesY = (pDrawTarget->height + nDrawTileSize - 1) / nDrawTileSize;
+
+		// Counting sort, commands keep their submission order inside every tile
+		vTileStart.assign(size_t(nTilesX * nTilesY) + 1, 0);
+		for (const auto& c : vTileCommands)
+		{
+			if (c.x1 >= c.x2 || c.y1 >= c.y2) continue;
+			pDrawTarget->MarkDirty(c.x1, c.y1, c.x2, c.y2);
+			for (int32_t ty = c.y1 / nDrawTileSize; ty <= (c.y2 - 1) / nDrawTileSize; ty++)
+				for (int32_t tx = c.x1 / nDrawTileSize; tx <= (c.x2 - 1) / nDrawTileSize; tx++)
+					vTileStart[ty * nTilesX + tx + 1]++;
+		}
+
+		for (size_t t = 1; t < vTileStart.size(); t++) vTileStart[t] += vTileStart[t - 1];
+		vTileItems.resize(vTileStart.back());
+		vTileCursor.assign(vTileStart.begin(), vTileStart.end() - 1);
+
+		for (uint32_t i = 0; i < uint32_t(vTileCommands.size()); i++)
+		{
+			const auto& c = vTileCommands[i];
+			if (c.x1 >= c.x2 || c.y1 >= c.y2) continue;
+			for (int32_t ty = c.y1 / nDrawTileSize; ty <= (c.y2 - 1) / nDrawTileSize; ty++)
+				for (int32_t tx = c.x1 / nDrawTileSize; tx <= (c.x2 - 1) / nDrawTileSize; tx++)
+					vTileItems[vTileCursor[ty * nTilesX + tx]++] = i;
+		}
+	}
+
+	void PixelGameEngine::RasterizeTile(uint32_t t)
+	{
+		const int32_t w = pDrawTarget->width;
+		const int32_t nTilesX = (w + nDrawTileSize - 1) / nDrawTileSize;
+		const int32_t tx1 = int32_t(t % nTilesX) * nDrawTileSize, tx2 = std::min(tx1 + nDrawTileSize, w);
+		const int32_t ty1 = int32_t(t / nTilesX) * nDrawTileSize, ty2 = std::min(ty1 + nDrawTileSize, pDrawTarget->height);
+		Pixel* pData = pDrawTarget->GetData();
+
+		for (uint32_t n = vTileStart[t]; n < vTileStart[t + 1]; n++)
+		{
+			const auto& c = vTileCommands[vTileItems[n]];
+			const int32_t y1 = std::max(c.y1, ty1), y2 = std::min(c.y2, ty2);
+			auto span = [&](Pixel* dst, size_t count)
+			{
+				if (c.mode == Pixel::NORMAL) FillPixels(dst, count, c.p);
+				else BlendPixels(dst, count, c.p, c.fBlend, c.mode == Pixel::PREMULTIPLIED);
+			};
+
+			if (c.nSpans < 0)
+			{
+				const int32_t x1 = std::max(c.x1, tx1), x2 = std::min(c.x2, tx2);
+				for (int32_t y = y1; y < y2; y++)
+					span(pData + y * w + x1, size_t(x2 - x1));
+			}
+			else
+			{
+				const int32_t* hw = vCircleSpans.data() + c.nSpans;
+				for (int32_t y = y1; y < y2; y++)
+				{
+					const int32_t r = hw[std::abs(y - c.cy)];
+					const int32_t x1 = std::max(c.cx - r, tx1), x2 = std::min(c.cx + r + 1, tx2);
+					if (r >= 0 && x1 < x2) span(pData + y * w + x1, size_t(x2 - x1));
+				}
+			}
+		}
+	}
+
+	uint32_t PixelGameEngine::CircleSpans(int32_t radius)
+	{
+		if (size_t(radius) >= vCircleSpanStart.size())
+			vCircleSpanStart.resize(size_t(radius) + 1, 0xFFFFFFFF);
+		if (vCircleSpanStart[radius] != 0xFFFFFFFF)
+			return vCircleSpanStart[radius];
+
+		// Same midpoint walk as FillCircle, rows are symmetric around the centre
+		const uint32_t nStart = uint32_t(vCircleSpans.size());
+		vCircleSpans.resize(nStart + radius + 1, -1);
+		int32_t* hw = vCircleSpans.data() + nStart;
+		if (radius == 0)
+			hw[0] = 0;
+		else
+		{
+			int x0 = 0;
+			int y0 = radius;
+			int d = 3 - 2 * radius;
+			while (y0 >= x0)
+			{
+				hw[x0] = std::max(hw[x0], y0);
+				if (d < 0)
+					d += 4 * x0++ + 6;
+				else
+				{
+					if (x0 != y0) hw[y0] = std::max(hw[y0], x0);
+					d += 4 * (x0++ - y0--) + 10;
+				}
+			}
+		}
+
+		vCircleSpanStart[radius] = nStart;
+		return nStart;
+	}
+
+	void PixelGameEngine::FillRects(std::span<const olc::vi2d> pos, std::span<const olc::vi2d> size, std::span<const olc::Pixel> col)
+	{
+		const size_t nCount = std::min({ pos.size(), size.size(), col.size() });
+		if (nPixelMode == Pixel::CUSTOM)
+		{
+			for (size_t i = 0; i < nCount; i++) FillRect(pos[i], size[i], col[i]);
+			return;
+		}
+
+		for (size_t i = 0; i < nCount; i++)
+			RecordRect(pos[i].x, pos[i].y, pos[i].x + size[i].x, pos[i].y + size[i].y, col[i], nPixelMode);
+		if (!bTiledRendering) FlushTiles();
+	}
+
+	void PixelGameEngine::FillCircles(std::span<const olc::vi2d> pos, std::span<const int32_t> radius, std::span<const olc::Pixel> col)
+	{
+		const size_t nCount = std::min({ pos.size(), radius.size(), col.size() });
+		if (nPixelMode == Pixel::CUSTOM)
+		{
+			for (size_t i = 0; i < nCount; i++) FillCircle(pos[i], radius[i], col[i]);
+			return;
+		}
+
+		for (size_t i = 0; i < nCount; i++)
+			RecordCircle(pos[i].x, pos[i].y, radius[i], col[i], nPixelMode);
+		if (!bTiledRendering) FlushTiles();
+	}
+
 	void PixelGameEngine::DrawRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p)
 	{
 		DrawRect(pos.x, pos.y, size.x, size.y, p);
@@ -2068,9 +2674,16 @@ namespace olc
 
 	void PixelGameEngine::Clear(Pixel p)
 	{
+		if (bTiledRendering)
+		{
+			// Everything recorded so far would be overwritten
+			vTileCommands.clear();
+			RecordRect(0, 0, GetDrawTargetWidth(), GetDrawTargetHeight(), p, Pixel::NORMAL);
+			return;
+		}
 		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
-		Pixel* m = GetDrawTarget()->GetData();
-		for (int i = 0; i < pixels; i++) m[i] = p;
+		FillPixels(GetDrawTarget()->GetData(), size_t(pixels), p);
+		GetDrawTarget()->MarkDirty(0, 0, GetDrawTargetWidth(), GetDrawTargetHeight());
 	}
 
 	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
@@ -2098,9 +2711,14 @@ namespace olc
 		if (y2 < 0) y2 = 0;
 		if (y2 >= (int32_t)GetDrawTargetHeight()) y2 = (int32_t)GetDrawTargetHeight();
 
+		if (bTiledRendering && nPixelMode != Pixel::CUSTOM)
+		{
+			RecordRect(x, y, x2, y2, p, nPixelMode);
+			return;
+		}
+
 		for (int j = y; j < y2; ++j)
-			for (int i = x; i < x2; ++i)
-				Draw(i, j, p);
+			FillSpan(x, x2 - 1, j, p);
 	}
 
 	void PixelGameEngine::DrawTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
@@ -2123,7 +2741,7 @@ namespace olc
 	// https://www.avrfreaks.net/sites/default/files/triangles.c
 	void PixelGameEngine::FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
 	{
-		auto drawline = [&](int sx, int ex, int ny) { for (int i = sx; i <= ex; i++) Draw(i, ny, p); };
+		auto drawline = [&](int sx, int ex, int ny) { FillSpan(sx, ex, ny, p); };
 
 		int t1x, t2x, y, minx, maxx, t1xp, t2xp;
 		bool changed1 = false;
@@ -2267,33 +2885,7 @@ namespace olc
 		if (sprite == nullptr)
 			return;
 
-		int32_t fxs = 0, fxm = 1, fx = 0;
-		int32_t fys = 0, fym = 1, fy = 0;
-		if (flip & olc::Sprite::Flip::HORIZ) { fxs = sprite->width - 1; fxm = -1; }
-		if (flip & olc::Sprite::Flip::VERT) { fys = sprite->height - 1; fym = -1; }
-
-		if (scale > 1)
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx, fy));
-			}
-		}
-		else
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx, fy));
-			}
-		}
+		DrawPartialSprite(x, y, sprite, 0, 0, sprite->width, sprite->height, scale, flip);
 	}
 
 	void PixelGameEngine::DrawPartialSprite(const olc::vi2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, uint32_t scale, uint8_t flip)
@@ -2306,6 +2898,14 @@ namespace olc
 		if (sprite == nullptr)
 			return;
 
+		// Blocks reaching outside the sprite sample through GetPixel, custom modes need
+		// every pixel's position and a sprite drawn onto itself must go in Draw's order
+		if (nPixelMode != Pixel::CUSTOM && sprite != pDrawTarget && ox >= 0 && oy >= 0 && ox + w <= sprite->width && oy + h <= sprite->height)
+		{
+			BlitSprite(x, y, sprite, ox, oy, w, h, int32_t(std::max(scale, 1u)), flip);
+			return;
+		}
+
 		int32_t fxs = 0, fxm = 1, fx = 0;
 		int32_t fys = 0, fym = 1, fy = 0;
 		if (flip & olc::Sprite::Flip::HORIZ) { fxs = w - 1; fxm = -1; }
@@ -2335,6 +2935,63 @@ namespace olc
 		}
 	}
 
+	void PixelGameEngine::BlitSprite(int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, int32_t scale, uint8_t flip)
+	{
+		assert(pDrawTarget && "No draw target active");
+		if (!vTileCommands.empty()) FlushTiles();
+		if (w <= 0 || h <= 0) return;
+
+		const int32_t x1 = std::max(x, 0), x2 = int32_t(std::min<int64_t>(int64_t(x) + int64_t(w) * scale, pDrawTarget->width));
+		const int32_t y1 = std::max(y, 0), y2 = int32_t(std::min<int64_t>(int64_t(y) + int64_t(h) * scale, pDrawTarget->height));
+		if (x1 >= x2 || y1 >= y2) return;
+		pDrawTarget->MarkDirty(x1, y1, x2, y2);
+
+		const bool bFlipX = flip & olc::Sprite::Flip::HORIZ;
+		const bool bFlipY = flip & olc::Sprite::Flip::VERT;
+		const size_t nCount = size_t(x2 - x1);
+
+		// Unflipped, unscaled rows are read straight from the sprite, anything else is
+		// rearranged into vBlitRow once per source row
+		const bool bDirect = scale == 1 && !bFlipX;
+		if (!bDirect) vBlitRow.resize(nCount);
+		int32_t nRowBuilt = -1;
+
+		for (int32_t py = y1; py < y2; py++)
+		{
+			const int32_t j = (py - y) / scale;
+			const int32_t sy = oy + (bFlipY ? h - 1 - j : j);
+			const Pixel* pSrc = sprite->GetData() + size_t(sy) * sprite->width + ox;
+			if (bDirect)
+			{
+				pSrc += x1 - x;
+			}
+			else
+			{
+				if (sy != nRowBuilt)
+				{
+					// Each source pixel covers scale destination pixels, the first maybe clipped
+					int32_t i = (x1 - x) / scale;
+					size_t nRun = size_t(scale - (x1 - x) % scale);
+					for (size_t n = 0; n < nCount; i++, nRun = size_t(scale))
+					{
+						const Pixel p = pSrc[bFlipX ? w - 1 - i : i];
+						for (const size_t nEnd = std::min(nCount, n + nRun); n < nEnd; n++) vBlitRow[n] = p;
+					}
+					nRowBuilt = sy;
+				}
+				pSrc = vBlitRow.data();
+			}
+
+			Pixel* pDst = pDrawTarget->GetData() + size_t(py) * pDrawTarget->width + x1;
+			if (nPixelMode == Pixel::NORMAL)
+				std::memcpy(pDst, pSrc, nCount * sizeof(Pixel));
+			else if (nPixelMode == Pixel::MASK)
+				MaskPixels(pDst, pSrc, nCount);
+			else
+				BlendPixels(pDst, pSrc, nCount, fBlendFactor, nPixelMode == Pixel::PREMULTIPLIED);
+		}
+	}
+
 	void PixelGameEngine::SetDecalMode(const olc::DecalMode& mode)
 	{
 		nDecalMode = mode;
@@ -2906,6 +3563,110 @@ namespace olc
 	}
 
 
+	void PixelGameEngine::UploadDirtyTiles(uint32_t nResID, olc::Sprite* spr)
+	{
+		if (spr->bDirtyAll)
+		{
+			renderer->UpdateTexture(nResID, spr);
+			spr->ClearDirty();
+			return;
+		}
+
+		// Consecutive tile rows with the same dirty tiles go up as one band, every run
+		// of dirty tiles in a band is one sub-image update
+		const int32_t nTilesX = spr->nDirtyTilesX;
+		const int32_t nTilesY = nTilesX ? int32_t(spr->vDirtyTiles.size()) / nTilesX : 0;
+		const uint8_t* pTiles = spr->vDirtyTiles.data();
+		for (int32_t ty1 = 0, ty2 = 0; ty1 < nTilesY; ty1 = ty2)
+		{
+			const uint8_t* pRow = pTiles + size_t(ty1) * nTilesX;
+			for (ty2 = ty1 + 1; ty2 < nTilesY && std::memcmp(pRow, pTiles + size_t(ty2) * nTilesX, nTilesX) == 0; ty2++);
+
+			for (int32_t tx1 = 0, tx2 = 0; tx1 < nTilesX; tx1 = tx2)
+			{
+				for (tx2 = tx1 + 1; tx2 < nTilesX && pRow[tx2] == pRow[tx1]; tx2++);
+				if (!pRow[tx1]) continue;
+				const olc::vi2d vPos = { tx1 * nDrawTileSize, ty1 * nDrawTileSize };
+				const olc::vi2d vEnd = { std::min(tx2 * nDrawTileSize, spr->width), std::min(ty2 * nDrawTileSize, spr->height) };
+				renderer->UpdateTextureRegion(nResID, spr, vPos, vEnd - vPos);
+			}
+		}
+		std::fill(spr->vDirtyTiles.begin(), spr->vDirtyTiles.end(), uint8_t(0));
+	}
+
+	void PixelGameEngine::BatchDecals(std::vector<DecalInstance>& vDecals)
+	{
+		// Only this many batches back are searched for a match, bounding the cost per decal
+		constexpr size_t nBatchWindow = 64;
+
+		auto count = [&](uint32_t& nDrawCalls, uint32_t& nStateChanges)
+		{
+			for (size_t i = 0; i < vDecals.size(); i++)
+			{
+				const bool bTexture = i == 0 || vDecals[i].decal != vDecals[i - 1].decal;
+				const bool bMode = i == 0 || vDecals[i].mode != vDecals[i - 1].mode;
+				if (!bTexture && !bMode) continue;
+				nDrawCalls++;
+				if (i > 0) nStateChanges += uint32_t(bTexture) + uint32_t(bMode);
+			}
+		};
+
+		uint32_t nDrawCallsBefore = 0, nStateChangesBefore = 0;
+		count(nDrawCallsBefore, nStateChangesBefore);
+
+		vDecalBatches.clear();
+		vDecalBatchOf.resize(vDecals.size());
+		for (size_t i = 0; i < vDecals.size(); i++)
+		{
+			const auto& d = vDecals[i];
+			float x1 = d.pos[0].x, y1 = d.pos[0].y, x2 = d.pos[0].x, y2 = d.pos[0].y;
+			for (int v = 1; v < 4; v++)
+			{
+				x1 = std::min(x1, d.pos[v].x); y1 = std::min(y1, d.pos[v].y);
+				x2 = std::max(x2, d.pos[v].x); y2 = std::max(y2, d.pos[v].y);
+			}
+
+			// Walk back to the newest batch this decal can join, stopping at anything it overlaps
+			size_t nBatch = vDecalBatches.size();
+			for (size_t b = vDecalBatches.size(); b > 0 && vDecalBatches.size() - b < nBatchWindow; b--)
+			{
+				const auto& batch = vDecalBatches[b - 1];
+				if (batch.decal == d.decal && batch.mode == d.mode) { nBatch = b - 1; break; }
+				if (x1 <= batch.x2 && batch.x1 <= x2 && y1 <= batch.y2 && batch.y1 <= y2) break;
+			}
+
+			if (nBatch == vDecalBatches.size())
+				vDecalBatches.push_back({ d.decal, d.mode, x1, y1, x2, y2 });
+			else
+			{
+				auto& batch = vDecalBatches[nBatch];
+				batch.x1 = std::min(batch.x1, x1); batch.y1 = std::min(batch.y1, y1);
+				batch.x2 = std::max(batch.x2, x2); batch.y2 = std::max(batch.y2, y2);
+			}
+			vDecalBatchOf[i] = uint32_t(nBatch);
+		}
+
+		// Stable counting sort by batch, keeps submission order inside every batch
+		if (vDecalBatches.size() < vDecals.size())
+		{
+			vDecalBatchStart.assign(vDecalBatches.size() + 1, 0);
+			for (uint32_t b : vDecalBatchOf) vDecalBatchStart[b + 1]++;
+			for (size_t b = 1; b < vDecalBatchStart.size(); b++) vDecalBatchStart[b] += vDecalBatchStart[b - 1];
+			vDecalScratch.resize(vDecals.size());
+			for (size_t i = 0; i < vDecals.size(); i++) vDecalScratch[vDecalBatchStart[vDecalBatchOf[i]]++] = vDecals[i];
+			vDecals.swap(vDecalScratch);
+		}
+
+		uint32_t nDrawCallsAfter = 0, nStateChangesAfter = 0;
+		count(nDrawCallsAfter, nStateChangesAfter);
+
+		sDecalStats.nDecals += uint32_t(vDecals.size());
+		sDecalStats.nDrawCalls += nDrawCallsAfter;
+		sDecalStats.nStateChanges += nStateChangesAfter;
+		sDecalStats.nDrawCallsSaved += int32_t(nDrawCallsBefore) - int32_t(nDrawCallsAfter);
+		sDecalStats.nStateChangesSaved += int32_t(nStateChangesBefore) - int32_t(nStateChangesAfter);
+	}
+
 	void PixelGameEngine::olc_CoreUpdate()
 	{
 		// Handle Timing
@@ -2915,6 +3676,9 @@ namespace olc
 
 		// Our time per frame coefficient
 		float fElapsedTime = elapsedTime.count();
+#if defined(OLC_PLATFORM_HEADLESS)
+		if (headless.fFixedElapsedTime > 0.0f) fElapsedTime = headless.fFixedElapsedTime;
+#endif
 		fLastElapsed = fElapsedTime;
 
 		// Some platforms will need to check for events
@@ -2957,6 +3721,7 @@ namespace olc
 			// Handle Frame Update
 		if (!OnUserUpdate(fElapsedTime))
 			bAtomActive = false;
+		FlushTiles();
 
 		// Display Frame
 		renderer->UpdateViewport(vViewPos, vViewSize);
@@ -2966,6 +3731,7 @@ namespace olc
 		vLayers[0].bUpdate = true;
 		vLayers[0].bShow = true;
 		renderer->PrepareDrawing();
+		sDecalStats = {};
 
 		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
 		{
@@ -2976,15 +3742,15 @@ namespace olc
 					renderer->ApplyTexture(layer->nResID);
 					if (layer->bUpdate)
 					{
-						renderer->UpdateTexture(layer->nResID, layer->pDrawTarget);
+						UploadDirtyTiles(layer->nResID, layer->pDrawTarget);
 						layer->bUpdate = false;
 					}
 
 					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
 
 					// Display Decals in order for this layer
-					for (auto& decal : layer->vecDecalInstance)
-						renderer->DrawDecalQuad(decal);
+					BatchDecals(layer->vecDecalInstance);
+					renderer->DrawDecals(layer->vecDecalInstance);
 					layer->vecDecalInstance.clear();
 				}
 				else
@@ -3118,6 +3884,39 @@ typedef X11::GLXContext glRenderContext_t;
 #include <OpenGL/glu.h>
 #endif
 
+// Pixel buffer streaming needs GL 4.4 or ARB_buffer_storage, which the GL 1.x headers
+// don't declare, so its entry points are loaded at runtime where the platform can
+#if defined(OLC_PLATFORM_WINAPI)
+#define CALLSTYLE __stdcall
+#define OGL_LOAD(t, n) (t*)wglGetProcAddress(#n)
+#else
+#define CALLSTYLE
+#endif
+
+#if defined(OLC_PLATFORM_X11)
+#define OGL_LOAD(t, n) (t*)X11::glXGetProcAddress((const unsigned char*)#n)
+#endif
+
+typedef ptrdiff_t locGLsizeiptr;
+typedef ptrdiff_t locGLintptr;
+typedef struct locGLsync_t* locGLsync;
+typedef void(CALLSTYLE locGenBuffers_t)(GLsizei n, GLuint* buffers);
+typedef void(CALLSTYLE locDeleteBuffers_t)(GLsizei n, const GLuint* buffers);
+typedef void(CALLSTYLE locBindBuffer_t)(GLenum target, GLuint buffer);
+typedef void(CALLSTYLE locBufferStorage_t)(GLenum target, locGLsizeiptr size, const void* data, GLbitfield flags);
+typedef void* (CALLSTYLE locMapBufferRange_t)(GLenum target, locGLintptr offset, locGLsizeiptr length, GLbitfield access);
+typedef GLboolean(CALLSTYLE locUnmapBuffer_t)(GLenum target);
+typedef locGLsync(CALLSTYLE locFenceSync_t)(GLenum condition, GLbitfield flags);
+typedef GLenum(CALLSTYLE locClientWaitSync_t)(locGLsync sync, GLbitfield flags, uint64_t timeout);
+typedef void(CALLSTYLE locDeleteSync_t)(locGLsync sync);
+constexpr GLenum locPIXEL_UNPACK_BUFFER = 0x88EC;
+constexpr GLbitfield locMAP_WRITE_BIT = 0x0002;
+constexpr GLbitfield locMAP_PERSISTENT_BIT = 0x0040;
+constexpr GLbitfield locMAP_COHERENT_BIT = 0x0080;
+constexpr GLenum locSYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+constexpr GLbitfield locSYNC_FLUSH_COMMANDS_BIT = 0x0001;
+constexpr GLenum locTIMEOUT_EXPIRED = 0x911B;
+
 namespace olc
 {
 	class Renderer_OGL10 : public olc::Renderer
@@ -3133,6 +3932,33 @@ namespace olc
 		bool bSync = false;
 		olc::DecalMode nDecalMode = olc::DecalMode(-1); // Thanks Gusgo & Bispoo
 
+		// Client side vertex array DrawDecals merges decal batches into
+		struct DecalVertex { float x, y; float u, v, z, w; olc::Pixel tint; };
+		std::vector<DecalVertex> vDecalVertices;
+
+		// Texture uploads are copied into a persistently mapped pixel buffer, split into
+		// one section per frame in flight. A section is fenced when its frame is displayed
+		// and only written again once the GPU has finished reading it. Without buffer
+		// storage, or while a frame's uploads outgrow the sections, uploads are synchronous
+		static constexpr uint32_t nStreamSections = 3;
+		bool bStreaming = false;
+		GLuint nStreamBuffer = 0;
+		uint8_t* pStreamMemory = nullptr;
+		size_t nStreamSectionSize = 0;
+		size_t nStreamUsed = 0;
+		size_t nStreamRequested = 0;
+		uint32_t nStreamSection = 0;
+		std::array<locGLsync, nStreamSections> vStreamFences{};
+		locGenBuffers_t* locGenBuffers = nullptr;
+		locDeleteBuffers_t* locDeleteBuffers = nullptr;
+		locBindBuffer_t* locBindBuffer = nullptr;
+		locBufferStorage_t* locBufferStorage = nullptr;
+		locMapBufferRange_t* locMapBufferRange = nullptr;
+		locUnmapBuffer_t* locUnmapBuffer = nullptr;
+		locFenceSync_t* locFenceSync = nullptr;
+		locClientWaitSync_t* locClientWaitSync = nullptr;
+		locDeleteSync_t* locDeleteSync = nullptr;
+
 #if defined(OLC_PLATFORM_X11)
 		X11::Display* olc_Display = nullptr;
 		X11::Window* olc_Window = nullptr;
@@ -3230,11 +4056,14 @@ namespace olc
 			glEnable(GL_TEXTURE_2D); // Turn on texturing
 			glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
 #endif
+			StartStreaming();
 			return olc::rcode::OK;
 		}
 
 		olc::rcode DestroyDevice() override
 		{
+			ReleaseStream();
+			bStreaming = false;
 #if defined(OLC_PLATFORM_WINAPI)
 			wglDeleteContext(glRenderContext);
 #endif
@@ -3252,6 +4081,7 @@ namespace olc
 
 		void DisplayFrame() override
 		{
+			EndStreamFrame();
 #if defined(OLC_PLATFORM_WINAPI)
 			SwapBuffers(glDeviceContext);
 			if (bSync) DwmFlush(); // Woooohooooooo!!!! SMOOOOOOOTH!
@@ -3345,6 +4175,41 @@ namespace olc
 			}
 		}
 
+		void DrawDecals(std::span<const olc::DecalInstance> decals) override
+		{
+			// GL 1.0 has no instancing, so each run of decals sharing a texture and mode
+			// becomes one vertex array and one draw call
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+
+			for (size_t i = 0; i < decals.size();)
+			{
+				const olc::Decal* decal = decals[i].decal;
+				const olc::DecalMode mode = decals[i].mode;
+
+				vDecalVertices.clear();
+				for (; i < decals.size() && decals[i].decal == decal && decals[i].mode == mode; i++)
+				{
+					const auto& d = decals[i];
+					// Textured decals are tinted by their first corner only, like DrawDecalQuad
+					for (int v = 0; v < 4; v++)
+						vDecalVertices.push_back({ d.pos[v].x, d.pos[v].y, d.uv[v].x, d.uv[v].y, 0.0f, d.w[v], decal ? d.tint[0] : d.tint[v] });
+				}
+
+				SetDecalMode(mode);
+				glBindTexture(GL_TEXTURE_2D, decal ? decal->id : 0);
+				glVertexPointer(2, GL_FLOAT, sizeof(DecalVertex), &vDecalVertices[0].x);
+				glTexCoordPointer(4, GL_FLOAT, sizeof(DecalVertex), &vDecalVertices[0].u);
+				glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(DecalVertex), &vDecalVertices[0].tint);
+				glDrawArrays(GL_QUADS, 0, GLsizei(vDecalVertices.size()));
+			}
+
+			glDisableClientState(GL_COLOR_ARRAY);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			glDisableClientState(GL_VERTEX_ARRAY);
+		}
+
 		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered) override
 		{
 			UNUSED(width);
@@ -3378,9 +4243,39 @@ namespace olc
 		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
 		{
 			UNUSED(id);
+			const locGLintptr nOffset = StreamPixels(spr, { 0, 0 }, { spr->width, spr->height });
+			if (nOffset >= 0)
+			{
+				locBindBuffer(locPIXEL_UNPACK_BUFFER, nStreamBuffer);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)nOffset);
+				locBindBuffer(locPIXEL_UNPACK_BUFFER, 0);
+				return;
+			}
+
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			UNUSED(id);
+			const locGLintptr nOffset = StreamPixels(spr, pos, size);
+			if (nOffset >= 0)
+			{
+				locBindBuffer(locPIXEL_UNPACK_BUFFER, nStreamBuffer);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)nOffset);
+				locBindBuffer(locPIXEL_UNPACK_BUFFER, 0);
+				return;
+			}
+
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, pos.x);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, pos.y);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+		}
+
 		void ApplyTexture(uint32_t id) override
 		{
 			glBindTexture(GL_TEXTURE_2D, id);
@@ -3401,6 +4296,117 @@ namespace olc
 			glViewport(pos.x, pos.y, size.x, size.y);
 #endif
 		}
+
+	private:
+		void StartStreaming()
+		{
+#if defined(OGL_LOAD)
+			int nMajor = 0, nMinor = 0;
+			const char* sVersion = (const char*)glGetString(GL_VERSION);
+			const char* sExtensions = (const char*)glGetString(GL_EXTENSIONS);
+			if (sVersion) sscanf(sVersion, "%d.%d", &nMajor, &nMinor);
+			const int nVersion = nMajor * 10 + nMinor;
+			if (nVersion < 44 && !(nVersion >= 32 && sExtensions && strstr(sExtensions, "GL_ARB_buffer_storage"))) return;
+
+			locGenBuffers = OGL_LOAD(locGenBuffers_t, glGenBuffers);
+			locDeleteBuffers = OGL_LOAD(locDeleteBuffers_t, glDeleteBuffers);
+			locBindBuffer = OGL_LOAD(locBindBuffer_t, glBindBuffer);
+			locBufferStorage = OGL_LOAD(locBufferStorage_t, glBufferStorage);
+			locMapBufferRange = OGL_LOAD(locMapBufferRange_t, glMapBufferRange);
+			locUnmapBuffer = OGL_LOAD(locUnmapBuffer_t, glUnmapBuffer);
+			locFenceSync = OGL_LOAD(locFenceSync_t, glFenceSync);
+			locClientWaitSync = OGL_LOAD(locClientWaitSync_t, glClientWaitSync);
+			locDeleteSync = OGL_LOAD(locDeleteSync_t, glDeleteSync);
+			bStreaming = locGenBuffers && locDeleteBuffers && locBindBuffer && locBufferStorage && locMapBufferRange
+				&& locUnmapBuffer && locFenceSync && locClientWaitSync && locDeleteSync;
+#endif
+		}
+
+		void ReleaseStream()
+		{
+			for (auto& fence : vStreamFences)
+			{
+				if (fence) locDeleteSync(fence);
+				fence = nullptr;
+			}
+
+			if (nStreamBuffer)
+			{
+				// The GL keeps the storage alive until uploads still reading it are done
+				locBindBuffer(locPIXEL_UNPACK_BUFFER, nStreamBuffer);
+				locUnmapBuffer(locPIXEL_UNPACK_BUFFER);
+				locBindBuffer(locPIXEL_UNPACK_BUFFER, 0);
+				locDeleteBuffers(1, &nStreamBuffer);
+			}
+
+			nStreamBuffer = 0;
+			pStreamMemory = nullptr;
+			nStreamSectionSize = 0;
+			nStreamSection = 0;
+		}
+
+		void ResizeStream(size_t nSectionSize)
+		{
+			ReleaseStream();
+			const GLbitfield nFlags = locMAP_WRITE_BIT | locMAP_PERSISTENT_BIT | locMAP_COHERENT_BIT;
+			const locGLsizeiptr nSize = locGLsizeiptr(nSectionSize * nStreamSections);
+			locGenBuffers(1, &nStreamBuffer);
+			locBindBuffer(locPIXEL_UNPACK_BUFFER, nStreamBuffer);
+			locBufferStorage(locPIXEL_UNPACK_BUFFER, nSize, nullptr, nFlags);
+			pStreamMemory = (uint8_t*)locMapBufferRange(locPIXEL_UNPACK_BUFFER, 0, nSize, nFlags);
+			locBindBuffer(locPIXEL_UNPACK_BUFFER, 0);
+
+			if (pStreamMemory == nullptr)
+			{
+				ReleaseStream();
+				bStreaming = false;
+				return;
+			}
+			nStreamSectionSize = nSectionSize;
+		}
+
+		// Copies a block of spr into this frame's section, returns its offset in the
+		// pixel buffer or -1 if the upload has to be synchronous
+		locGLintptr StreamPixels(olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size)
+		{
+			if (!bStreaming) return -1;
+			const size_t nRow = size_t(size.x) * sizeof(olc::Pixel);
+			const size_t nBytes = nRow * size_t(size.y);
+			nStreamRequested += nBytes;
+			if (nStreamUsed + nBytes > nStreamSectionSize) return -1;
+
+			const size_t nOffset = size_t(nStreamSection) * nStreamSectionSize + nStreamUsed;
+			const olc::Pixel* pSrc = spr->GetData() + size_t(pos.y) * spr->width + pos.x;
+			for (int32_t y = 0; y < size.y; y++)
+				std::memcpy(pStreamMemory + nOffset + y * nRow, pSrc + size_t(y) * spr->width, nRow);
+			nStreamUsed += nBytes;
+			return locGLintptr(nOffset);
+		}
+
+		void EndStreamFrame()
+		{
+			if (!bStreaming) return;
+			if (nStreamUsed > 0) vStreamFences[nStreamSection] = locFenceSync(locSYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			if (nStreamRequested > nStreamSectionSize)
+			{
+				// Grow with some headroom so next frame's uploads fit, the sections start out empty
+				ResizeStream(nStreamRequested + nStreamRequested / 2);
+			}
+			else
+			{
+				nStreamSection = (nStreamSection + 1) % nStreamSections;
+				if (auto& fence = vStreamFences[nStreamSection])
+				{
+					while (locClientWaitSync(fence, locSYNC_FLUSH_COMMANDS_BIT, 1000000) == locTIMEOUT_EXPIRED);
+					locDeleteSync(fence);
+					fence = nullptr;
+				}
+			}
+
+			nStreamUsed = 0;
+			nStreamRequested = 0;
+		}
 	};
 }
 #endif
@@ -3410,6 +4416,51 @@ namespace olc
 
 
 
+// O------------------------------------------------------------------------------O
+// | START RENDERER: Null, draws nothing, for the headless platform               |
+// O------------------------------------------------------------------------------O
+#if defined(OLC_GFX_NULL)
+namespace olc
+{
+	class Renderer_Null : public olc::Renderer
+	{
+	private:
+		uint32_t nNextTexture = 1;
+
+	public:
+		void PrepareDevice() override {}
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+			UNUSED(params); UNUSED(bFullScreen); UNUSED(bVSYNC);
+			return olc::rcode::OK;
+		}
+		olc::rcode DestroyDevice() override { return olc::rcode::OK; }
+		void DisplayFrame() override {}
+		void PrepareDrawing() override {}
+		void SetDecalMode(const olc::DecalMode& mode) override { UNUSED(mode); }
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override { UNUSED(offset); UNUSED(scale); UNUSED(tint); }
+		void DrawDecalQuad(const olc::DecalInstance& decal) override { UNUSED(decal); }
+		void DrawDecals(std::span<const olc::DecalInstance> decals) override { UNUSED(decals); }
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered) override
+		{
+			UNUSED(width); UNUSED(height); UNUSED(filtered);
+			return nNextTexture++;
+		}
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override { UNUSED(id); UNUSED(spr); }
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override { UNUSED(id); UNUSED(spr); UNUSED(pos); UNUSED(size); }
+		uint32_t DeleteTexture(const uint32_t id) override { return id; }
+		void ApplyTexture(uint32_t id) override { UNUSED(id); }
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override { UNUSED(pos); UNUSED(size); }
+		void ClearBuffer(olc::Pixel p, bool bDepth) override { UNUSED(p); UNUSED(bDepth); }
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END RENDERER: Null                                                           |
+// O------------------------------------------------------------------------------O
+
+
+
 
 // O------------------------------------------------------------------------------O
 // | START IMAGE LOADER: GDI+, Windows Only, always exists, a little slow         |
@@ -4431,6 +5482,112 @@ namespace olc {
 
 
 
+// O------------------------------------------------------------------------------O
+// | START PLATFORM: HEADLESS, no window, set up through olc::headless            |
+// O------------------------------------------------------------------------------O
+#if defined(OLC_PLATFORM_HEADLESS)
+namespace olc
+{
+	class Platform_Headless : public olc::Platform
+	{
+	private:
+		uint32_t nFrame = 0;
+		std::chrono::steady_clock::time_point tpStart;
+		std::chrono::steady_clock::time_point tpNextFrame;
+
+		// Layer 0 is only finished once the next frame starts, or the engine stops
+		void DumpFrame(uint32_t nDumped)
+		{
+			if (headless.nDumpEvery == 0 || nDumped % headless.nDumpEvery != 0) return;
+			auto& layers = ptrPGE->GetLayers();
+			if (layers.empty()) return;
+			layers[0].pDrawTarget->SaveToPGESprFile(headless.sDumpPath + std::to_string(nDumped) + ".spr");
+		}
+
+	public:
+		virtual olc::rcode ApplicationStartUp() override
+		{
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode ApplicationCleanUp() override
+		{
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode ThreadStartUp() override
+		{
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode ThreadCleanUp() override
+		{
+			if (nFrame > 0) DumpFrame(nFrame - 1);
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tpStart;
+			if (nFrame > 0)
+				std::cout << "Headless: " << nFrame << " frames in " << elapsed.count() << "s, "
+					<< elapsed.count() * 1000.0 / nFrame << "ms per frame\n";
+			renderer->DestroyDevice();
+			return olc::OK;
+		}
+
+		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize) override
+		{
+			if (renderer->CreateDevice({}, bFullScreen, bEnableVSYNC) == olc::rcode::OK)
+			{
+				renderer->UpdateViewport(vViewPos, vViewSize);
+				tpStart = std::chrono::steady_clock::now();
+				tpNextFrame = tpStart;
+				return olc::rcode::OK;
+			}
+			else
+				return olc::rcode::FAIL;
+		}
+
+		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) override
+		{
+			UNUSED(vWindowPos); UNUSED(vWindowSize); UNUSED(bFullScreen);
+			return olc::OK;
+		}
+
+		virtual olc::rcode SetWindowTitle(const std::string& s) override
+		{
+			UNUSED(s);
+			return olc::OK;
+		}
+
+		virtual olc::rcode StartSystemEventLoop() override
+		{
+			return olc::OK;
+		}
+
+		// Runs at the start of every frame, before input is scanned
+		virtual olc::rcode HandleSystemEvent() override
+		{
+			if (nFrame > 0) DumpFrame(nFrame - 1);
+
+			if (headless.fFrameRate > 0.0f)
+			{
+				std::this_thread::sleep_until(tpNextFrame);
+				tpNextFrame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.0f / headless.fFrameRate));
+			}
+
+			if (headless.funcInput) headless.funcInput(*ptrPGE, nFrame);
+
+			// The loop only checks for shut down after a frame, so stop one early
+			if (headless.nFrames > 0 && nFrame + 1 >= headless.nFrames) ptrPGE->olc_Terminate();
+			nFrame++;
+			return olc::OK;
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END PLATFORM: HEADLESS                                                       |
+// O------------------------------------------------------------------------------O
+
+
+
 namespace olc
 {
 	void PixelGameEngine::olc_ConfigureSystem()
@@ -4463,12 +5620,20 @@ namespace olc
 		platform = std::make_unique<olc::Platform_GLUT>();
 #endif
 
+#if defined(OLC_PLATFORM_HEADLESS)
+		platform = std::make_unique<olc::Platform_Headless>();
+#endif
+
 
 
 #if defined(OLC_GFX_OPENGL10)
 		renderer = std::make_unique<olc::Renderer_OGL10>();
 #endif
 
+#if defined(OLC_GFX_NULL)
+		renderer = std::make_unique<olc::Renderer_Null>();
+#endif
+
 #if defined(OLC_GFX_OPENGL33)
 		renderer = std::make_unique<olc::Renderer_OGL33>();
 #endif